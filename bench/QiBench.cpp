@@ -0,0 +1,297 @@
+// qi_bench: timings of the validator's hot paths on the generated graph sets and on
+// synthetic random graphs, written as Google Benchmark compatible JSON so runs of
+// different solver versions can be compared with the usual tooling.
+//
+//   qi_bench [--out <file.json>] [--min-time <seconds>] [--filter <substring>]
+//            [--limit <graphs per set>] [graph_dir|manifest ...]
+//
+// Without directories it benchmarks graphs/special, graphs/procedural and
+// graphs/robertson (whichever exist) plus the synthetic densities.
+
+#include "../include/BatchRunner.h"
+#include "../include/Dsatur.h"
+#include "../include/ExactQiSolver.h"
+#include "../include/Graph.h"
+#include "../include/McOperations.h"
+#include "../include/Partition.h"
+#include "../include/QiBranchAndBound.h"
+#include "../include/QuotientGraph.h"
+#include "../include/Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// largest quotient handed to the exact solvers, so one graph cannot stall the run
+const int EXACT_BENCH_BLOCKS = 20;
+
+struct BenchResult {
+    std::string name;
+    long long iterations;
+    double real_time_ns;    // per iteration
+};
+
+// keeps results observable so the timed calls are not optimised away
+volatile long long sink;
+
+class Bench {
+public:
+    Bench(double min_time, const std::string& filter) : min_time_(min_time), filter_(filter) {}
+
+    // time body once, then repeatedly until min_time has elapsed
+    void run(const std::string& name, const std::function<long long()>& body) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+        long long iterations = 0;
+        Clock::time_point start = Clock::now();
+        double elapsed = 0;
+        do {
+            sink = body();
+            iterations++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < min_time_);
+        results_.push_back({name, iterations, elapsed * 1e9 / iterations});
+        std::cout << std::left << std::setw(60) << name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(0) << results_.back().real_time_ns << " ns" << std::setw(10)
+                  << iterations << std::endl;
+    }
+
+    const std::vector<BenchResult>& getResults() const { return results_; }
+
+private:
+    double min_time_;
+    std::string filter_;
+    std::vector<BenchResult> results_;
+};
+
+// the partition a random chain reaches at target_blocks (or where it gets stuck)
+Partition chainPartition(const Graph& graph, int target_blocks, uint64_t seed) {
+    std::vector<int> identity(graph.num_vertices);
+    for (int v = 0; v < graph.num_vertices; v++) identity[v] = v;
+    Partition partition(identity.data(), graph.num_vertices);
+    Xoshiro256 rng(seed);
+    int block1, block2;
+    while (partition.getNumBlocks() > target_blocks &&
+           McOperations::chooseRandomMcOperation(partition, graph, rng, block1, block2)) {
+        partition.mergeBlocks(block1, block2);
+    }
+    return partition;
+}
+
+template <int Words>
+void benchSolvers(Bench& bench, const std::string& prefix, const QuotientGraph& quotient, int required_qi) {
+    BlockSet<Words> adjacency[BlockSet<Words>::CAPACITY];
+    int block_labels[QuotientGraph::MAX_BLOCKS];
+    int count = quotient.compact(adjacency, block_labels);
+    std::string suffix = "/k=" + std::to_string(count);
+
+    bench.run(prefix + "dsatur" + suffix, [&] {
+        Dsatur<Words> dsatur(adjacency, count);
+        return static_cast<long long>(dsatur.color());
+    });
+    bench.run(prefix + "branch_and_bound" + suffix, [&] {
+        QiBranchAndBound<Words> solver(adjacency, count);
+        return static_cast<long long>(solver.solve(required_qi).lower);
+    });
+    if (std::thread::hardware_concurrency() > 1) {
+        bench.run(prefix + "branch_and_bound_parallel" + suffix, [&] {
+            QiBranchAndBound<Words> solver(adjacency, count);
+            solver.setThreads(0);
+            return static_cast<long long>(solver.solve(required_qi).lower);
+        });
+    }
+    if (count > EXACT_BENCH_BLOCKS) return;
+    bench.run(prefix + "exact_full" + suffix, [&] {
+        ExactQiSolver<Words> solver(adjacency, count);
+        return static_cast<long long>(solver.solve());
+    });
+    bench.run(prefix + "exact_early_stop" + suffix, [&] {
+        ExactQiSolver<Words> solver(adjacency, count);
+        return static_cast<long long>(solver.solve(required_qi));
+    });
+}
+
+// everything after loading, on one graph
+void benchGraph(Bench& bench, const std::string& prefix, const Graph& graph) {
+    int n = graph.num_vertices;
+    if (n < 2 || n > Partition::MAX_VERTICES) return;
+
+    // halfway down the chain: a typical quotient for the build and the Mc scan
+    Partition middle = chainPartition(graph, std::max(graph.critical_k, n / 2), 1);
+    std::vector<int> labels(middle.getPartitionArray(), middle.getPartitionArray() + n);
+    bench.run(prefix + "quotient_build/k=" + std::to_string(middle.getNumBlocks()), [&] {
+        Partition partition(labels.data(), n);
+        return static_cast<long long>(partition.getQuotientGraph(graph).getNumBlocks());
+    });
+
+    // a quarter of the way: coarse blocks, where the build pools member rows
+    Partition coarse = chainPartition(graph, std::max(graph.critical_k, n / 4), 1);
+    std::vector<int> coarse_labels(coarse.getPartitionArray(), coarse.getPartitionArray() + n);
+    bench.run(prefix + "quotient_build/k=" + std::to_string(coarse.getNumBlocks()), [&] {
+        Partition partition(coarse_labels.data(), n);
+        return static_cast<long long>(partition.getQuotientGraph(graph).getNumBlocks());
+    });
+
+    std::vector<int> block1_array;
+    std::vector<int> block2_array;
+    middle.getQuotientGraph(graph);
+    bench.run(prefix + "find_mc_operations/k=" + std::to_string(middle.getNumBlocks()), [&] {
+        return static_cast<long long>(McOperations::findAllMcOperations(middle, graph, block1_array,
+                                                                        block2_array));
+    });
+
+    // the solvers on the partition a chain reaches at the exact-solver size
+    Partition small = chainPartition(graph, std::max(graph.critical_k, std::min(n, EXACT_BENCH_BLOCKS)), 1);
+    const QuotientGraph& quotient = small.getQuotientGraph(graph);
+    int required_qi = small.getNumBlocks() - graph.critical_k + 1;
+    if (quotient.getNumBlocks() <= BlockSet<1>::CAPACITY) {
+        benchSolvers<1>(bench, prefix, quotient, required_qi);
+    } else if (quotient.getNumBlocks() <= BlockSet<2>::CAPACITY) {
+        benchSolvers<2>(bench, prefix, quotient, required_qi);
+    } else {
+        benchSolvers<4>(bench, prefix, quotient, required_qi);
+    }
+
+    // the large-quotient fast path on the graph itself
+    Partition full = chainPartition(graph, n, 1);
+    const QuotientGraph& full_quotient = full.getQuotientGraph(graph);
+    if (n > EXACT_BENCH_BLOCKS) {
+        BlockSet<4> adjacency[BlockSet<4>::CAPACITY];
+        int block_labels[QuotientGraph::MAX_BLOCKS];
+        int count = full_quotient.compact(adjacency, block_labels);
+        bench.run(prefix + "dsatur/k=" + std::to_string(count), [&] {
+            Dsatur<4> dsatur(adjacency, count);
+            return static_cast<long long>(dsatur.color());
+        });
+    }
+}
+
+// G(n, p) with a fixed seed; critical_k only sets the solvers' thresholds
+Graph randomGraph(int n, double density, uint64_t seed) {
+    Graph graph;
+    graph.init(n);
+    graph.critical_k = std::max(2, n / 4);
+    Xoshiro256 rng(seed);
+    for (int u = 0; u < n; u++) {
+        for (int v = u + 1; v < n; v++) {
+            if (static_cast<double>(rng() >> 11) * 0x1.0p-53 < density) graph.addEdge(u, v);
+        }
+    }
+    graph.buildAdjacencyLists();
+    return graph;
+}
+
+// Google Benchmark's JSON layout (context plus one entry per benchmark)
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"num_cpus\": "
+        << std::thread::hardware_concurrency() << ",\n    \"library_build_type\": \""
+#ifdef NDEBUG
+        << "release"
+#else
+        << "debug"
+#endif
+        << "\",\n    \"quotient_build_kernel\": \"" << QuotientGraph::getBuildKernel()
+        << "\"\n  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"run_type\": \"iteration\", \"iterations\": "
+            << result.iterations << ", \"real_time\": " << std::fixed << std::setprecision(1)
+            << result.real_time_ns << ", \"cpu_time\": " << result.real_time_ns
+            << ", \"time_unit\": \"ns\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output_file = "";
+    double min_time = 0.1;
+    std::string filter = "";
+    int limit = 10;
+    std::vector<std::string> sets;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--limit" && i + 1 < argc) {
+            limit = std::atoi(argv[++i]);
+        } else {
+            sets.push_back(arg);
+        }
+    }
+    bool default_sets = sets.empty();
+    if (default_sets) sets = {"graphs/special", "graphs/procedural", "graphs/robertson"};
+
+    Bench bench(min_time, filter);
+    for (const std::string& set : sets) {
+        std::vector<std::string> files;
+        std::string error;
+        if (default_sets && !std::filesystem::exists(set)) continue;
+        if (!BatchRunner::collectGraphFiles(set, files, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+
+        // an evenly spaced sample keeps the large sets from dominating the run
+        std::vector<std::string> sample;
+        int stride = (limit > 0 && static_cast<int>(files.size()) > limit)
+                         ? static_cast<int>(files.size()) / limit : 1;
+        for (size_t i = 0; i < files.size() && (limit <= 0 || static_cast<int>(sample.size()) < limit);
+             i += stride) {
+            sample.push_back(files[i]);
+        }
+
+        for (const std::string& file : sample) {
+            std::string prefix = std::filesystem::path(file).stem().string() + "/";
+            Graph graph;
+            bench.run(prefix + "load", [&] {
+                Graph loaded;
+                loaded.loadFromFile(file.c_str());
+                return static_cast<long long>(loaded.num_vertices);
+            });
+            if (!graph.loadFromFile(file.c_str())) continue;
+            benchGraph(bench, prefix, graph);
+        }
+    }
+
+    const int sizes[] = {30, 60, 120};
+    const double densities[] = {0.1, 0.3, 0.5};
+    for (int n : sizes) {
+        for (double density : densities) {
+            std::ostringstream prefix;
+            prefix << "random_n" << n << "_p" << std::fixed << std::setprecision(1) << density << "/";
+            benchGraph(bench, prefix.str(), randomGraph(n, density, 1000 * n + static_cast<int>(density * 10)));
+        }
+    }
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not write to output file " << output_file << std::endl;
+            return 1;
+        }
+        writeJson(out, bench.getResults());
+        std::cout << "Results written to " << output_file << std::endl;
+    }
+    return 0;
+}
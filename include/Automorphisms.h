@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Graph.h"
+#include <vector>
+
+// automorphisms of a graph, listed element by element for the exhaustive explorer's
+// symmetry reduction. A group larger than max_order is cut down to the pointwise
+// stabiliser of the first few vertices of the search order: still a group, so orbit
+// representatives stay canonical, only fewer symmetric partitions are identified.
+class Automorphisms {
+public:
+    static const int MAX_ORDER = 5040;
+
+    explicit Automorphisms(const Graph& graph, int max_order = MAX_ORDER);
+
+    // elements held; element 0 is the identity
+    int getOrder() const { return order_; }
+
+    // vertices every element fixes because the full group was too large (0: full group)
+    int getFixedVertices() const { return fixed_; }
+
+    // image of every vertex under element g, and its inverse
+    const int* getImages(int g) const { return images_.data() + static_cast<size_t>(g) * n_; }
+    const int* getInverse(int g) const { return inverses_.data() + static_cast<size_t>(g) * n_; }
+
+private:
+    const Graph& graph_;
+    int n_;
+    int max_order_;
+    int order_;
+    int fixed_;
+    std::vector<int> images_;
+    std::vector<int> inverses_;
+
+    // search state: vertices in the order they are mapped, and the refined colours
+    // an image must match
+    std::vector<int> search_order_;
+    std::vector<int> colour_;
+    std::vector<int> image_;
+    std::vector<bool> used_;
+
+    void refineColours();
+    void chooseSearchOrder();
+    bool extend(int depth);
+};
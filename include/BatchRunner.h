@@ -0,0 +1,77 @@
+#pragma once
+
+#include "MergePolicy.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// one graph's line in a batch results file; fields mirror the --output report
+struct BatchEntry {
+    std::string graph;
+    int vertices = 0;
+    int critical_k = 0;
+    uint64_t seed = 0;          // --seed with this value replays the chain on its own
+    int steps = 0;
+    std::string result;         // PASS, FAIL, PARTIAL, TIMEOUT, SKIPPED or ERROR
+    std::string detail;
+    double seconds = 0.0;
+};
+
+// validates many graph files in one process: one random chain per graph, graphs
+// shared out across a worker pool, each under its own wall-clock budget
+class BatchRunner {
+public:
+    // num_threads <= 0 uses every hardware thread; time_budget_seconds <= 0 means no limit
+    BatchRunner(int num_threads, uint64_t base_seed, double time_budget_seconds);
+
+    // per-step qi search limits passed on to each chain (see ChainRunner::setStepBudget)
+    void setStepBudget(long long max_nodes, double max_seconds);
+
+    // merge policy of every graph's chain (see ChainRunner::setMergePolicy)
+    void setMergePolicy(MergePolicy policy, int beam_width);
+
+    // only graphs whose index in the file list is shard_index mod num_shards; every graph
+    // keeps the seed of its global index, so merged shards match an unsharded run
+    void setShard(int shard_index, int num_shards);
+
+    // append each graph's entry to path as soon as it is done; with resume, graphs whose
+    // entry (same seed) is already there are taken from it instead of being run again
+    void setCheckpoint(const std::string& path, bool resume);
+
+    // every .txt or .qig graph under a directory (recursively, sorted; a .qig replaces the
+    // .txt of the same name), or the paths listed in a
+    // manifest file (one per line, '#' comments, relative to the manifest's directory).
+    // Returns false with a message in error when path cannot be read.
+    static bool collectGraphFiles(const std::string& path, std::vector<std::string>& files,
+                                  std::string& error);
+
+    // graph i runs on stream Xoshiro256::streamSeed(base_seed, i); entries of the shard
+    // come back in file order whatever the scheduling. Returns false with a message in
+    // error when the checkpoint cannot be read or written.
+    bool run(const std::vector<std::string>& files, std::vector<BatchEntry>& entries,
+             std::string& error) const;
+
+    static void writeJsonLines(std::ostream& out, const std::vector<BatchEntry>& entries);
+    static void writeCsv(std::ostream& out, const std::vector<BatchEntry>& entries);
+
+    // entries of a file written by writeJsonLines (a results file or a checkpoint); a
+    // line cut short by a crash is skipped. Returns false when path cannot be opened.
+    static bool readJsonLines(const std::string& path, std::vector<BatchEntry>& entries,
+                              std::string& error);
+
+private:
+    int num_threads_;
+    uint64_t base_seed_;
+    double time_budget_seconds_;
+    long long step_nodes_;
+    double step_seconds_;
+    MergePolicy policy_;
+    int beam_width_;
+    int shard_index_;
+    int num_shards_;
+    std::string checkpoint_path_;
+    bool resume_;
+
+    BatchEntry validateGraph(const std::string& file, uint64_t seed) const;
+};
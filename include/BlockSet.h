@@ -0,0 +1,104 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+// fixed-capacity bitset over dense quotient block indices (64 * Words blocks)
+template <int Words>
+struct BlockSet {
+    static const int CAPACITY = 64 * Words;
+
+    uint64_t words[Words];
+
+    // set with no blocks
+    static BlockSet none() {
+        BlockSet s;
+        for (int w = 0; w < Words; w++) s.words[w] = 0;
+        return s;
+    }
+
+    // set containing blocks 0..count-1
+    static BlockSet firstN(int count) {
+        BlockSet s = none();
+        for (int w = 0; w < Words && count > 0; w++, count -= 64) {
+            s.words[w] = (count >= 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+        }
+        return s;
+    }
+
+    void set(int i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(int i) { words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    bool any() const {
+        for (int w = 0; w < Words; w++) {
+            if (words[w]) return true;
+        }
+        return false;
+    }
+    bool empty() const { return !any(); }
+
+    int count() const {
+        int c = 0;
+        for (int w = 0; w < Words; w++) c += std::popcount(words[w]);
+        return c;
+    }
+
+    // index of the lowest set bit, -1 when empty
+    int lowest() const {
+        for (int w = 0; w < Words; w++) {
+            if (words[w]) return (w << 6) + std::countr_zero(words[w]);
+        }
+        return -1;
+    }
+
+    // remove and return the lowest set bit, -1 when empty
+    int popLowest() {
+        for (int w = 0; w < Words; w++) {
+            if (words[w]) {
+                int bit = std::countr_zero(words[w]);
+                words[w] &= words[w] - 1;
+                return (w << 6) + bit;
+            }
+        }
+        return -1;
+    }
+
+    bool intersects(const BlockSet& other) const {
+        for (int w = 0; w < Words; w++) {
+            if (words[w] & other.words[w]) return true;
+        }
+        return false;
+    }
+
+    // blocks in this set but not in other
+    BlockSet without(const BlockSet& other) const {
+        BlockSet s;
+        for (int w = 0; w < Words; w++) s.words[w] = words[w] & ~other.words[w];
+        return s;
+    }
+
+    BlockSet operator&(const BlockSet& other) const {
+        BlockSet s;
+        for (int w = 0; w < Words; w++) s.words[w] = words[w] & other.words[w];
+        return s;
+    }
+
+    BlockSet operator|(const BlockSet& other) const {
+        BlockSet s;
+        for (int w = 0; w < Words; w++) s.words[w] = words[w] | other.words[w];
+        return s;
+    }
+
+    BlockSet& operator|=(const BlockSet& other) {
+        for (int w = 0; w < Words; w++) words[w] |= other.words[w];
+        return *this;
+    }
+
+    bool operator==(const BlockSet& other) const {
+        for (int w = 0; w < Words; w++) {
+            if (words[w] != other.words[w]) return false;
+        }
+        return true;
+    }
+};
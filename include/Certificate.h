@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Graph.h"
+#include "Partition.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// JSON Lines stream of qi certificates for one chain. The first line names the run
+// ({"graph", "vertices", "critical_k", "seed"}); every PASS step then adds
+//   {"step":s,"blocks":k,"colors":c,"labels":[...],"cover":[...]}
+// with each vertex's block label and the color of its block in a proper coloring of
+// the quotient. Such a coloring is a cover by c independent block sets, so qi >= k - c.
+class CertificateWriter {
+public:
+    // returns false when path cannot be written
+    bool open(const std::string& path, const std::string& graph_file, const Graph& graph, uint64_t seed);
+
+    // certify the partition reached at step; falls back to one color per block (qi >= 0)
+    // when the partition carries no witness cover
+    void writeStep(int step, const Partition& partition);
+
+    int getStepsWritten() const { return steps_written_; }
+
+private:
+    std::ofstream out_;
+    int steps_written_ = 0;
+};
+
+// checks a certificate file against its graph in time linear in vertices plus edges per
+// step, without any search: every cover must be a proper coloring of its quotient with
+// k - c >= k - k' + 1, and each step's partition must coarsen the previous one (the
+// all-singletons start for the first) by exactly the number of steps between them,
+// joining only blocks that are connected in the previous quotient. Steps without a
+// certificate (undetermined ones are never written) are reported by getMissingSteps.
+class CertificateVerifier {
+public:
+    explicit CertificateVerifier(const Graph& graph);
+
+    // false with a message in error at the first invalid line
+    bool verify(const std::string& path, std::string& error);
+
+    int getStepsVerified() const { return steps_verified_; }
+    int getLastStep() const { return last_step_; }
+
+    // steps up to the last one that had no certificate line, ascending
+    const std::vector<int>& getMissingSteps() const { return missing_steps_; }
+    std::string formatMissingSteps() const;
+
+private:
+    const Graph& graph_;
+    int steps_verified_;
+    int last_step_;
+    int last_blocks_;
+    std::vector<int> last_labels_;
+    std::vector<int> missing_steps_;
+
+    bool verifyStep(int step, int blocks, int colors, const std::vector<int>& labels,
+                    const std::vector<int>& cover, std::string& error);
+};
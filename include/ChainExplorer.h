@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Automorphisms.h"
+#include "ChainRunner.h"
+#include "Graph.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Partition;
+
+// outcome of exploring every Mc chain from P* down to k'
+struct ExplorationResult {
+    std::vector<StepTally> tallies;     // per block count, one entry per distinct partition
+    std::vector<long long> states;      // distinct partitions seen per block count
+    long long total_states = 0;
+    long long total_orbits = 0;         // states actually expanded: one per orbit
+    int group_order = 1;                // automorphisms used for the reduction
+    int final_blocks = 0;               // smallest level reached
+    bool failed = false;
+    bool final_undetermined = false;
+};
+
+// breadth-first exploration of all Mc chains. Partitions reached by different merge
+// orders are identified by their canonical labelling (each block labelled by its first
+// vertex), so each distinct partition has its qi computed exactly once. Only the
+// current level and the next one are kept in memory.
+//
+// Automorphisms of the graph map Mc chains onto Mc chains and keep qi, so partitions
+// in one orbit of the automorphism group are explored once, through the orbit's least
+// canonical labelling, and counted with the orbit's size: tallies and state counts are
+// those of the unreduced exploration.
+class ChainExplorer {
+public:
+    // use_symmetry = false explores every partition (the group is just the identity)
+    explicit ChainExplorer(const Graph& graph, bool use_symmetry = true);
+
+    ExplorationResult explore() const;
+
+    const Automorphisms& getAutomorphisms() const { return group_; }
+
+    // write the frontier (the level just finished, tallies so far) to path after every
+    // level, replacing the previous one
+    void setCheckpoint(const std::string& path) { checkpoint_path_ = path; }
+
+    // make explore() continue from a frontier written by an earlier run on the same
+    // graph and group; a missing file means there is nothing to resume. False with a
+    // message in error when the file is unreadable or belongs to another exploration.
+    bool resumeFrom(const std::string& path, std::string& error);
+
+    // block count of the resumed level (0: explore() starts from P*)
+    int getResumedBlocks() const { return resumed_blocks_; }
+
+private:
+    // one explored orbit of a level
+    struct OrbitState {
+        int qi;
+        long long size;
+    };
+    using Level = std::unordered_map<std::string, OrbitState>;
+
+    const Graph& graph_;
+    Automorphisms group_;
+    std::string checkpoint_path_;
+    int resumed_blocks_;
+    ExplorationResult resumed_result_;
+    Level resumed_level_;
+
+    std::string orbitKey(const Partition& partition, long long& orbit_size) const;
+    uint64_t fingerprint() const;
+    void saveCheckpoint(int num_blocks, const ExplorationResult& result, const Level& level) const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Graph.h"
+#include "MergePolicy.h"
+#include "QiCounters.h"
+#include "Rng.h"
+#include "SearchBudget.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// PASS/FAIL/UNDETERMINED counts for the partitions of one size (number of blocks)
+struct StepTally {
+    long long pass = 0;
+    long long fail = 0;
+    long long undetermined = 0;
+};
+
+// outcome of following one random chain of Mc operations from P* towards k'
+struct ChainResult {
+    uint64_t seed = 0;          // stream seed; --seed with this value replays the chain
+    int steps = 0;              // Mc operations performed
+    int final_blocks = 0;
+    bool failed = false;        // some step had qi below k - k' + 1
+    bool final_undetermined = false;
+    bool timed_out = false;     // stopped at the deadline before reaching k'
+    int undecided_steps = 0;    // steps whose qi interval still straddled the threshold
+    QiCounters counters;        // qi work done by this chain
+    double max_step_seconds = 0.0;
+};
+
+// follows random Mc chains over one read-only graph; a single runner can be shared by
+// many threads because every chain owns its partition and RNG stream
+class ChainRunner {
+public:
+    explicit ChainRunner(const Graph& graph);
+
+    // cap every qi search at max_nodes search nodes and/or max_seconds (<= 0: no cap);
+    // a step that runs out is tallied UNDETERMINED and the chain carries on
+    void setStepBudget(long long max_nodes, double max_seconds);
+
+    // how each chain picks its merges (MergePolicy, uniform by default); a Beam "chain"
+    // follows the beam_width partitions with the lowest cheap qi interval of each level,
+    // every one of them checked and tallied
+    void setMergePolicy(MergePolicy policy, int beam_width);
+
+    // follow one chain, adding each checked partition to tallies[num_blocks]
+    ChainResult runChain(Xoshiro256& rng, std::vector<StepTally>& tallies) const;
+
+    // same, but stop between steps once deadline has passed
+    ChainResult runChain(Xoshiro256& rng, std::vector<StepTally>& tallies,
+                         std::chrono::steady_clock::time_point deadline) const;
+
+    // run num_chains independent chains on num_threads workers; chain i draws from the
+    // stream Xoshiro256::streamSeed(base_seed, i), independent of scheduling.
+    // Returns tallies indexed by block count.
+    std::vector<StepTally> runChains(int num_chains, int num_threads, uint64_t base_seed,
+                                     std::vector<ChainResult>& results) const;
+
+private:
+    const Graph& graph_;
+    long long step_nodes_;
+    double step_seconds_;
+    MergePolicy policy_;
+    int beam_width_;
+
+    ChainResult runBeam(Xoshiro256& rng, std::vector<StepTally>& tallies,
+                        std::chrono::steady_clock::time_point deadline) const;
+
+    // budget for one step, never running past the chain's own deadline
+    SearchBudget stepBudget(std::chrono::steady_clock::time_point deadline) const;
+};
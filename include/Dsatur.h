@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BlockSet.h"
+
+// DSATUR greedy coloring of a dense quotient graph given as per-block neighbour masks.
+// All state lives in fixed-capacity members (saturation heap included), so a call
+// never allocates; the number of colors used is an upper bound on chi.
+template <int Words>
+class Dsatur {
+public:
+    using Set = BlockSet<Words>;
+
+    Dsatur(const Set* adjacency, int block_count);
+
+    // color every block; returns the number of colors used
+    int color();
+
+    int getNumColors() const { return num_colors_; }
+    int getColor(int block) const { return color_[block]; }
+
+private:
+    const Set* adjacency_;
+    int block_count_;
+    int num_colors_;
+
+    int color_[Set::CAPACITY];
+    Set neighbour_colors_[Set::CAPACITY];
+    int saturation_[Set::CAPACITY];
+    int degree_[Set::CAPACITY];     // degree among uncolored blocks
+
+    // binary max-heap of uncolored blocks ordered by (saturation, degree)
+    int heap_[Set::CAPACITY];
+    int heap_pos_[Set::CAPACITY];
+    int heap_size_;
+
+    bool higherPriority(int block1, int block2) const;
+    void siftUp(int pos);
+    void siftDown(int pos);
+    int popMax();
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "BlockSet.h"
+
+// exact qi engine over a dense quotient graph given as one neighbour mask per block.
+// qi = k - (minimum number of disjoint independent sets covering the quotient), so the
+// search picks the lowest uncovered block, enumerates only the maximal independent sets
+// of the uncovered blocks that contain it, and carries the "used" state as one mask.
+// The search runs on an explicit stack: one frame per block added to the cover (at
+// most k), taken from a per-thread arena that is reused across solves.
+template <int Words>
+class ExactQiSolver {
+public:
+    using Set = BlockSet<Words>;
+
+    ExactQiSolver(const Set* adjacency, int block_count);
+
+    // exact qi over all blocks
+    int solve();
+
+    // exact qi, but stops as soon as qi >= min_required_qi has been found
+    int solve(int min_required_qi);
+
+    // independent set holding block in the best cover found (its color)
+    int getColor(int block) const { return best_color_[block]; }
+
+private:
+    // one independent set being grown: the recursion state of a Bron-Kerbosch call
+    struct Frame {
+        Set chosen;
+        Set candidates;
+        Set excluded;
+        Set branch;         // pivot branch blocks not yet tried
+        int cover_size;     // sets chosen before this one: its level of the cover
+    };
+
+    const Set* adjacency_;
+    int block_count_;
+    int min_required_qi_;
+    int max_qi_;
+
+    // sets chosen along the current branch, copied to best_color_ on each improvement
+    Set cover_[Set::CAPACITY];
+    int cover_size_;
+    int best_color_[Set::CAPACITY];
+
+    // added to QiCounters once per solve
+    long long nodes_;
+    long long sets_;
+
+    // the search stack, frames_[0..depth_), and per cover level the blocks it has left
+    // to cover and the qi of the sets below it
+    Frame* frames_;
+    int depth_;
+    Set level_remaining_[Set::CAPACITY];
+    int level_qi_[Set::CAPACITY];
+
+    static Frame* arena(int block_count);
+    bool startSet(const Set& remaining, int current_qi, Set& chosen, Set& candidates);
+    void growSet(Set remaining, Set chosen, Set candidates, Set excluded, int current_qi);
+    void search();
+};
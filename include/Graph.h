@@ -1,20 +1,50 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 class Graph {
 public:
     Graph();
     void init(int vertices);
-    ~Graph();
     void addEdge(int src, int dest);
     void addConnection(int src, int dest);
     bool hasEdge(int src, int dest) const;
     int getEdgeCount() const;
+    
+    // text ("n", "u v" per edge, "k=<k'>") or the binary format written by saveBinary,
+    // told apart by the file's first bytes; the file is memory-mapped and parsed in place.
+    // Graphs over Partition::MAX_VERTICES vertices are rejected. Problems are printed.
     bool loadFromFile(const char* filename);
-    int* getAdjMatrix() const { return adjMatrix_; }
+    
+    // same, but the reason for a failure goes to error and a note about ignored edge
+    // lines to warning (empty when there is none) instead of being printed
+    bool loadFromFile(const char* filename, std::string& error, std::string& warning);
+    
+    // compact binary form: a 16-byte header then the bit rows, loaded with one copy
+    bool saveBinary(const char* filename) const;
+    
+    // bit-packed adjacency: vertex v's row is getRowWords() words, bit u set for each edge
+    const uint64_t* getAdjacencyRow(int vertex) const { return adj_bits_.data() + vertex * row_words_; }
+    int getRowWords() const { return row_words_; }
+    
+    // CSR neighbour lists in ascending order; rebuilt by buildAdjacencyLists after edits
+    void buildAdjacencyLists();
+    int getDegree(int vertex) const { return neighbour_offsets_[vertex + 1] - neighbour_offsets_[vertex]; }
+    const int* getNeighbours(int vertex) const { return neighbours_.data() + neighbour_offsets_[vertex]; }
     
     int num_vertices;
     int critical_k;
 
 private:
-    int* adjMatrix_;
-};
\ No newline at end of file
+    int row_words_;
+    
+    bool loadText(const char* data, size_t size, std::string& error, std::string& warning);
+    bool loadBinary(const char* data, size_t size, const char* filename, std::string& error);
+    bool hasValidRows() const;
+    std::vector<uint64_t> adj_bits_;
+    std::vector<int> neighbour_offsets_;
+    std::vector<int> neighbours_;
+};
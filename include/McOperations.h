@@ -2,16 +2,27 @@
 
 #include "Partition.h"
 #include "Graph.h"
+#include "Rng.h"
+#include <vector>
 
 class McOperations {
 public:
-    // find all possible Mc operations (merge connected blocks)
+    // find all possible Mc operations (merge connected blocks), one per quotient edge
+    // with block1 < block2 in ascending order. The arrays are refilled, so callers that
+    // keep them across steps reuse their capacity.
     static int findAllMcOperations(const Partition& partition, const Graph& graph, 
-                                   int* block1_array, int* block2_array);
+                                   std::vector<int>& block1_array, std::vector<int>& block2_array);
     
     // perform Mc operation - merge two connected blocks
     static Partition performMcOperation(const Partition& partition, int block1, int block2);
     
-    // choose random Mc operation from available options
-    static Partition performRandomMcOperation(const Partition& partition, const Graph& graph);
+    // pick a random Mc operation without applying it; returns false when none exists,
+    // so hot loops can merge in place instead of copying the partition
+    static bool chooseRandomMcOperation(const Partition& partition, const Graph& graph,
+                                        Xoshiro256& rng, int& block1, int& block2);
+    
+    // choose random Mc operation from available options, drawing from the caller's
+    // RNG stream (one per chain, so chains are reproducible and thread-safe)
+    static Partition performRandomMcOperation(const Partition& partition, const Graph& graph,
+                                              Xoshiro256& rng);
 };
\ No newline at end of file
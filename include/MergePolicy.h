@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Graph.h"
+#include "Partition.h"
+#include "Rng.h"
+#include <string>
+#include <vector>
+
+// how a chain picks its next Mc operation. Steered policies score each candidate merge
+// by the cheap qi interval of the partition it leads to (Partition::estimateQiBounds):
+// every child has the same threshold, so a lower qi upper bound is a child closer to
+// failing it.
+//   - uniform: every candidate equally likely (the plain random chains)
+//   - greedy: the lowest upper bound, then the lowest lower bound; ties at random
+//   - anneal: candidate c with weight exp(-(upper(c) - lowest upper) / T), the
+//     temperature cooling linearly from ANNEAL_TEMPERATURE at P* to 0 at k'
+//   - beam: not a per-step choice; ChainRunner keeps the best scored partitions of
+//     every level instead of a single chain
+// All randomness comes from the chain's stream, so --seed with the same policy replays
+// a chain.
+enum class MergePolicy { Uniform, Greedy, Anneal, Beam };
+
+// "uniform", "greedy", "anneal" or "beam"
+bool parseMergePolicy(const std::string& name, MergePolicy& policy);
+const char* mergePolicyName(MergePolicy policy);
+
+// picks merges for one chain; holds the candidate buffers, so keep one per chain
+class MergeSelector {
+public:
+    static constexpr double ANNEAL_TEMPERATURE = 2.0;
+
+    // policy must not be Beam
+    MergeSelector(const Graph& graph, MergePolicy policy);
+
+    // the next Mc operation for partition; false when none exists
+    bool choose(const Partition& partition, Xoshiro256& rng, int& block1, int& block2);
+
+private:
+    const Graph& graph_;
+    MergePolicy policy_;
+    std::vector<int> block1_array_;
+    std::vector<int> block2_array_;
+    std::vector<QiBounds> scores_;
+    std::vector<double> weights_;
+    MergeLog log_;
+
+    void scoreCandidates(const Partition& partition, int num_operations);
+};
@@ -1,60 +1,171 @@
 #pragma once
 
+#include "QiBounds.h"
+#include "QuotientGraph.h"
+#include "SearchBudget.h"
+#include <vector>
+
 // forward declaration
 class Graph;
+class QuotientKernel;
+
+// undo records for merges applied in place, rolled back last-in first-out. Kept by
+// the caller so a search can backtrack through merges without copying partitions.
+class MergeLog {
+public:
+    // pre-size for a search depth so merges never allocate
+    void reserve(int merges) { entries_.reserve(merges); }
+    bool empty() const { return entries_.empty(); }
+    int size() const { return static_cast<int>(entries_.size()); }
+
+private:
+    friend class Partition;
+
+    struct Entry {
+        int block1;
+        int block2;
+        int block1_tail;    // last vertex of block1 before block2 was spliced on
+        int block2_slot;    // block2's position in the active label list
+        bool quotient_built;
+        QuotientGraph::Row block1_row;
+        QuotientGraph::Row block2_row;
+        bool qi_calculated;
+        int qi_number;
+        QiBounds qi_bounds;
+    };
+    std::vector<Entry> entries_;
+};
 
 class Partition {
 public:
-    static const int MAX_VERTICES = 100;
+    // largest graph a partition can hold; storage is sized to the actual graph
+    static const int MAX_VERTICES = QuotientGraph::MAX_BLOCKS;
+    
+    // largest quotient solved exactly; above this only DSATUR bounds are tried
+    static const int EXACT_QI_MAX_BLOCKS = 30;
+    
+    // node cap on the branch and bound run for larger quotients when DSATUR falls short
+    static const long long LARGE_QUOTIENT_SEARCH_NODES = 20000;
+
+#if QI_SAT_BACKEND
+    // conflict cap on the SAT decision of a threshold the branch and bound left open
+    static const long long SAT_MAX_CONFLICTS = 200000;
+#endif
+    
+    // threads one branch and bound search may split into when a serial probe does not
+    // settle it (<= 0: every hardware thread); process-wide, 1 by default
+    static void setSearchThreads(int num_threads) { search_threads_ = num_threads; }
     
     // constructors
     Partition();
     Partition(const int* partition_array, int num_vertices);
-    Partition(const Partition& other);
-    
-    // assignment operator
-    Partition& operator=(const Partition& other);
     
     // basic accessors
     int getLabel(int vertex) const;
     void setLabel(int vertex, int label);
     int getNumVertices() const { return num_vertices_; }
-    const int* getPartitionArray() const { return partition_; }
+    const int* getPartitionArray() const { return partition_.data(); }
     
-    // essential block operations (array-based)
-    int getNumBlocks() const;
+    // essential block operations (array-based), maintained across merges
+    int getNumBlocks() const { return num_blocks_; }
     void getBlockVertices(int block_label, int* vertices, int& count) const;
     
+    // the getNumBlocks() labels in use, in no particular order
+    const int* getBlockLabels() const { return active_labels_.data(); }
+    
+    // labels with every block renamed to its first vertex, so partitions that group the
+    // vertices identically get identical arrays regardless of merge order
+    void getCanonicalLabels(int* labels) const;
+    
     // property calculations require graph
     void calculateQiNumber(const Graph& graph);
     void calculateQiNumber(const Graph& graph, int min_required_qi);
+    
+    // same, but the search gives up when budget runs out: qi is then -1 (UNDETERMINED)
+    // unless the bounds proven so far already decide the threshold
+    void calculateQiNumber(const Graph& graph, int min_required_qi, SearchBudget& budget);
     int getQiNumber() const { return qi_number_; }
     
+    // interval proven by the last calculation (exhausted set if its budget ran out)
+    const QiBounds& getQiBounds() const { return qi_bounds_; }
+    
+    // interval from one DSATUR coloring and one greedy clique of the quotient, without
+    // any search; leaves the qi state untouched (used to steer merge policies)
+    QiBounds estimateQiBounds(const Graph& graph) const;
+    
     // essential for Mc operations - check if blocks are connected in quotient
     bool areBlocksConnectedInQuotient(const Graph& graph, int block1, int block2) const;
     
+    // block-level adjacency, built on first use and updated in place by mergeBlocks
+    const QuotientGraph& getQuotientGraph(const Graph& graph) const;
+    
     // merge two blocks (Mc operation)
     void mergeBlocks(int block1, int block2);
+    
+    // merge two non-empty blocks in place, recording what undoMerge needs to restore
+    void mergeBlocks(int block1, int block2, MergeLog& log);
+    
+    // roll back the most recent merge recorded in log (quotient and qi cache included;
+    // the witness cover is dropped)
+    void undoMerge(MergeLog& log);
+    
+    // qi lower bound from the carried witness cover, -1 when there is none
+    int getWitnessQi() const { return witness_valid_ ? num_blocks_ - witness_colors_ : -1; }
+    
+    // that cover's color for each block label in use (colors need not be consecutive);
+    // false when there is none
+    bool getWitnessCover(int* label_colors) const;
 
 private:
-    int partition_[MAX_VERTICES];
+    static int search_threads_;
+    
+    std::vector<int> partition_;
     int num_vertices_;
+    int label_bound_;   // every label is below this; label-indexed vectors have this size
+    
+    // intrusive vertex list per block: head/tail by label, successor by vertex (-1 ends)
+    std::vector<int> block_head_;
+    std::vector<int> block_tail_;
+    std::vector<int> next_in_block_;
+    
+    // compact list of labels in use; label_slot_ gives each one's position in it
+    int num_blocks_;
+    std::vector<int> active_labels_;
+    std::vector<int> label_slot_;
+    
+    // lazily built quotient graph, maintained across merges
+    mutable QuotientGraph quotient_;
+    
+    // witness cover: a proper coloring of the quotient (one independent block set per
+    // color) from the last solve, recolored locally on each merge so the next step
+    // starts from a proven qi lower bound
+    mutable std::vector<int> witness_color_;   // by label
+    mutable std::vector<int> color_size_;      // blocks per color
+    mutable int witness_colors_;               // colors in use
+    mutable bool witness_valid_;
     
     // cached qi number
     mutable bool qi_calculated_;
     mutable int qi_number_;
+    mutable QiBounds qi_bounds_;
     
     // helper methods
-    void copyFrom(const Partition& other);
+    void rebuildBlockLists();
+    void relabelBlock(int first_vertex, int label);
+    void addActiveLabel(int label);
+    void removeActiveLabel(int label);
+    void recolorMergedBlock(int block1, int block2);
+    void adoptWitness(const int* label_colors) const;
     void invalidateQiCache();
     int calculateQiNumberInternal(const Graph& graph) const;
-    int calculateQiNumberInternal(const Graph& graph, int min_required_qi) const;
-    int calculateQiNumberInternalExhaustive(const Graph& graph) const;
-    void findOptimalQi(const int* block_labels, int label_count, 
-                      const bool quotient_adj[MAX_VERTICES][MAX_VERTICES],
-                      bool* used, int start_idx, int current_qi, int& max_qi) const;
-    void findOptimalQi(const int* block_labels, int label_count, 
-                      const bool quotient_adj[MAX_VERTICES][MAX_VERTICES],
-                      bool* used, int start_idx, int current_qi, int& max_qi, 
-                      int min_required_qi) const;
+    int calculateQiNumberInternal(const Graph& graph, int min_required_qi, SearchBudget* budget) const;
+    int searchQiNumber(const Graph& graph, int min_required_qi, SearchBudget* budget, int witness_qi) const;
+    int calculateQiNumberInternalExhaustive(const QuotientKernel& kernel) const;
+    int calculateQiNumberExact(const QuotientKernel& kernel, int min_required_qi) const;
+    QiBounds calculateQiBounds(const QuotientKernel& kernel, int min_required_qi, SearchBudget* budget) const;
+#if QI_SAT_BACKEND
+    QiBounds decideQiWithSat(const QuotientKernel& kernel, int min_required_qi, QiBounds bounds,
+                             SearchBudget* budget) const;
+#endif
+    int calculateDsaturColors(const QuotientKernel& kernel) const;
 };
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+// proven interval for the qi number of a quotient graph: lower <= qi <= upper
+struct QiBounds {
+    int lower;
+    int upper;
+    bool exhausted = false;     // the search budget ran out before the interval closed
+
+    bool isExact() const { return lower == upper; }
+    bool certifies(int required_qi) const { return lower >= required_qi; }
+    bool refutes(int required_qi) const { return upper < required_qi; }
+};
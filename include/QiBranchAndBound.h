@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BlockSet.h"
+#include "QiBounds.h"
+#include "SearchBudget.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// branch-and-bound qi solver: since qi = k - chi(quotient), it runs a DSATUR-ordered
+// exact coloring whose first dive is the DSATUR heuristic (an upper bound on chi, i.e.
+// a qi lower bound) and uses a greedy clique as a lower bound on chi (a qi upper bound).
+// With a required qi the search only looks for colorings with at most k - required
+// colors, so it both certifies and refutes the threshold without exhaustive search.
+// An optional budget caps the search; when it runs out the proven interval so far is
+// returned with exhausted set. With several threads, a search still open after a
+// serial probe is split into subtrees that the threads take in turn; they share the
+// best coloring, so every thread prunes against it and a certified threshold stops all.
+template <int Words>
+class QiBranchAndBound {
+public:
+    using Set = BlockSet<Words>;
+
+    QiBranchAndBound(const Set* adjacency, int block_count, SearchBudget* budget = nullptr);
+
+    // threads a search may use once the probe has not settled it (<= 0: every hardware
+    // thread; the default 1 keeps it serial)
+    void setThreads(int num_threads);
+
+    // exact qi as a (degenerate) interval
+    QiBounds solve();
+
+    // proven interval, refined only until it decides qi >= min_required_qi
+    QiBounds solve(int min_required_qi);
+
+    int getCliqueSize() const { return clique_size_; }
+    int getDsaturColors() const { return dsatur_colors_; }
+    
+    // color of a block in the best coloring found (a witness for the lower bound)
+    int getColor(int block) const { return best_color_[block]; }
+    
+    // whether any complete coloring was found (otherwise getColor is the identity)
+    bool hasColoring() const { return best_colors_.load() <= block_count_; }
+
+private:
+    // nodes searched serially before splitting, so quick searches never start threads
+    static const long long PARALLEL_AFTER_NODES = 1 << 14;
+    static const int TASKS_PER_THREAD = 64;
+
+    // a subtree root: the partial coloring so far and the blocks still uncolored
+    struct Task {
+        std::vector<Set> members;
+        Set uncolored;
+    };
+
+    const Set* adjacency_;
+    int block_count_;
+    SearchBudget* budget_;
+    int num_threads_;
+    QiBranchAndBound* root_;    // holds the shared best coloring (this, except in workers)
+
+    // blocks per color in the current partial coloring
+    Set color_members_[Set::CAPACITY];
+    int best_color_[Set::CAPACITY];
+
+    int clique_size_;
+    int dsatur_colors_;
+    std::atomic<int> best_colors_;  // fewest colors of any complete coloring found so far
+    std::atomic<int> color_limit_;  // only colorings with fewer colors than this are searched
+    std::mutex best_mutex_;         // guards best_color_ while threads share the search
+    int stop_colors_;   // a coloring with this many colors or fewer ends the search
+    int cap_colors_;    // decision mode: colorings needing this many colors are useless
+    long long nodes_;   // added to QiCounters once per run
+    long long probe_nodes_; // serial nodes before the search is split (0: never)
+    bool probe_cut_;        // the probe ran out and left the search open
+    std::vector<Task> frontier_;    // subtrees the probe left unsearched, in search order
+
+    int bestColors() const { return root_->best_colors_.load(std::memory_order_relaxed); }
+    int colorLimit() const { return root_->color_limit_.load(std::memory_order_relaxed); }
+    bool stopped() const { return probe_cut_ || (budget_ && budget_->isExhausted()); }
+
+    int greedyClique() const;
+    QiBounds run(int target_colors, int cap_colors);
+    int selectBlock(const Set& uncolored, int colors_used) const;
+    void colorRemaining(Set uncolored, int colors_used);
+    void recordColoring(int colors_used);
+    void saveFrontier(int block, const Set& uncolored, int colors_used, int first_color);
+    void searchParallel();
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "QiBounds.h"
+#include "QuotientGraph.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// process-wide cache of proven qi intervals, keyed by the quotient graph up to
+// isomorphism, so a quotient met again (in another chain, another seed or another
+// graph) is a lookup instead of a search. Each entry keeps a proper coloring proving
+// its lower bound, so a cached PASS still has a witness cover. Safe to share between
+// threads (sharded locks); optionally loaded from and saved to a file between runs.
+class QiCache {
+public:
+    // quotients with more blocks are never cached, nor ones with fewer than MIN_BLOCKS,
+    // which the exact solver settles faster than they are keyed
+    static const int MAX_BLOCKS = 64;
+    static const int MIN_BLOCKS = 12;
+
+    // up to this many blocks keys are fully canonical when colour refinement leaves few
+    // enough ties; above it, ties keep block order, which only costs hits, never
+    // correctness (a key always encodes the complete adjacency). With MIN_BLOCKS at the
+    // same value this only covers 12-block quotients: smaller ones are not cached at all.
+    static const int CANONICAL_BLOCKS = 12;
+
+    struct Entry {
+        QiBounds bounds;
+        std::vector<uint8_t> colors;    // by canonical position; k - colors = bounds.lower
+    };
+
+    static QiCache& global();
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool isEnabled() const { return enabled_; }
+
+    // canonical key of a quotient with at most MAX_BLOCKS blocks; order receives the
+    // block label at each canonical position
+    static std::string canonicalKey(const QuotientGraph& quotient, int* order);
+
+    bool lookup(const std::string& key, Entry& entry) const;
+
+    // intersect with what is already known; the coloring of the better lower bound wins
+    void store(const std::string& key, const Entry& entry);
+
+    size_t size() const;
+
+    // binary cache file; a missing file loads as empty. Entries whose coloring or
+    // interval does not hold on the adjacency in their key are skipped and counted in
+    // dropped.
+    bool load(const std::string& path, std::string& error, size_t& dropped);
+    bool save(const std::string& path, std::string& error) const;
+
+private:
+    static const int SHARDS = 16;
+    static const size_t MAX_ENTRIES_PER_SHARD = 1 << 15;   // full shards stop growing
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    bool enabled_ = true;
+    Shard shards_[SHARDS];
+
+    Shard& shardFor(const std::string& key) { return shards_[std::hash<std::string>()(key) % SHARDS]; }
+    const Shard& shardFor(const std::string& key) const {
+        return shards_[std::hash<std::string>()(key) % SHARDS];
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+// work done by the qi calculations, counted per thread with plain increments (no
+// atomics) and read back as the difference of two snapshots taken on that thread
+struct QiCounters {
+    long long search_nodes = 0;       // branch and bound and exact solver nodes
+    long long independent_sets = 0;   // maximal independent sets enumerated by the exact solver
+    long long dsatur_calls = 0;
+    long long exact_path = 0;         // thresholds checked on the exact path (<= 30 blocks)
+    long long fast_path = 0;          // thresholds checked on the DSATUR path (> 30 blocks)
+    long long witness_hits = 0;       // thresholds met by the carried witness cover alone
+    long long cache_lookups = 0;      // quotients looked up in the qi cache
+    long long cache_hits = 0;         // thresholds decided by a cached interval alone
+    long long sat_path = 0;           // thresholds handed to the SAT backend (QI_SAT_BACKEND)
+    long long sat_conflicts = 0;
+
+    // this thread's counters
+    static QiCounters& local() {
+        thread_local QiCounters counters;
+        return counters;
+    }
+
+    QiCounters& operator+=(const QiCounters& other) {
+        search_nodes += other.search_nodes;
+        independent_sets += other.independent_sets;
+        dsatur_calls += other.dsatur_calls;
+        exact_path += other.exact_path;
+        fast_path += other.fast_path;
+        witness_hits += other.witness_hits;
+        cache_lookups += other.cache_lookups;
+        cache_hits += other.cache_hits;
+        sat_path += other.sat_path;
+        sat_conflicts += other.sat_conflicts;
+        return *this;
+    }
+
+    QiCounters operator-(const QiCounters& since) const {
+        QiCounters delta;
+        delta.search_nodes = search_nodes - since.search_nodes;
+        delta.independent_sets = independent_sets - since.independent_sets;
+        delta.dsatur_calls = dsatur_calls - since.dsatur_calls;
+        delta.exact_path = exact_path - since.exact_path;
+        delta.fast_path = fast_path - since.fast_path;
+        delta.witness_hits = witness_hits - since.witness_hits;
+        delta.cache_lookups = cache_lookups - since.cache_lookups;
+        delta.cache_hits = cache_hits - since.cache_hits;
+        delta.sat_path = sat_path - since.sat_path;
+        delta.sat_conflicts = sat_conflicts - since.sat_conflicts;
+        return delta;
+    }
+};
+
+// peak resident set size of this process in kilobytes (0 where unsupported)
+long long peakMemoryKb();
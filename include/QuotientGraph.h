@@ -0,0 +1,88 @@
+#pragma once
+
+#include "BlockSet.h"
+#include <cstdint>
+#include <vector>
+
+// forward declaration
+class Graph;
+
+// block-level adjacency of a partition, indexed by block label. Built once from the
+// vertex graph and then kept current across merges, which only touch the two merged
+// rows and the rows of their neighbours.
+class QuotientGraph {
+public:
+    using Row = BlockSet<4>;
+    static const int MAX_BLOCKS = Row::CAPACITY;
+
+    QuotientGraph();
+    
+    // copies only the rows of live blocks; rows of other labels are unspecified
+    QuotientGraph(const QuotientGraph& other);
+    QuotientGraph& operator=(const QuotientGraph& other);
+
+    // vertices as a bitset padded to one 256-bit vector
+    struct alignas(32) VertexMask {
+        uint64_t words[4];
+    };
+
+    // full build: coarse partitions OR each block's member adjacency rows and map the
+    // reached vertices to blocks (see selectKernel); fine ones walk the CSR edges once
+    void build(const Graph& graph, const int* partition, int num_vertices);
+
+    // instruction set the build's block tests run on: "avx512", "avx2" or "portable"
+    static const char* getBuildKernel() { return selectKernel().name; }
+    void clear();
+    bool isBuilt() const { return built_; }
+
+    bool areAdjacent(int block1, int block2) const { return rows_[block1].test(block2); }
+    const Row& getNeighbours(int block) const { return rows_[block]; }
+    const Row& getBlocks() const { return blocks_; }
+    int getNumBlocks() const { return blocks_.count(); }
+
+    // merge block2 into block1: OR the rows together and drop block2
+    void mergeBlocks(int block1, int block2);
+
+    // exact inverse of mergeBlocks(block1, block2) given both rows from before the merge
+    void unmergeBlocks(int block1, int block2, const Row& block1_row, const Row& block2_row);
+
+    // copy the adjacency onto consecutive indices (ascending label order);
+    // returns the block count and fills block_labels with index -> label
+    template <int Words>
+    int compact(BlockSet<Words>* adjacency, int* block_labels) const;
+
+private:
+    // reached-vertex to block mapping, chosen once per process from the CPU
+    struct Kernel {
+        const char* name;
+        void (*test)(const VertexMask& reached, const VertexMask* members, const Row& blocks, Row& row);
+        int scatter_weight;    // cost of scattering one reached vertex, in block tests
+    };
+    static const Kernel& selectKernel();
+
+    std::vector<Row> rows_;     // one per label below the largest label at build time
+    Row blocks_;
+    bool built_;
+
+    void copyFrom(const QuotientGraph& other);
+};
+
+template <int Words>
+int QuotientGraph::compact(BlockSet<Words>* adjacency, int* block_labels) const {
+    int label_to_index[MAX_BLOCKS];
+    int count = 0;
+    Row remaining = blocks_;
+    for (int label = remaining.popLowest(); label >= 0; label = remaining.popLowest()) {
+        label_to_index[label] = count;
+        block_labels[count++] = label;
+    }
+
+    for (int i = 0; i < count; i++) {
+        adjacency[i] = BlockSet<Words>::none();
+        Row neighbours = rows_[block_labels[i]];
+        for (int label = neighbours.popLowest(); label >= 0; label = neighbours.popLowest()) {
+            adjacency[i].set(label_to_index[label]);
+        }
+    }
+    return count;
+}
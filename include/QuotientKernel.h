@@ -0,0 +1,112 @@
+#pragma once
+
+#include "BlockSet.h"
+#include "QuotientGraph.h"
+
+// the quotient graph shrunk to its irreducible core before a qi search. Each rule
+// removes a block whose color can always be chosen once the rest is colored:
+//   - universal: adjacent to every other block, so it needs a color of its own
+//     (chi drops by one with it, qi is unchanged)
+//   - dominated: a non-neighbour's neighbourhood contains its own, so it can share
+//     that block's color (isolated blocks are the empty case; chi is unchanged)
+//   - low degree: fewer neighbours than a clique of the rest, so some color of any
+//     coloring of the rest is free for it (chi is unchanged)
+// Rules are applied to a fixpoint; qi(quotient) = qi(kernel) + getQiOffset(), and a
+// coloring of the kernel lifts back to one of the quotient with
+// getUniversalBlocks() more colors.
+class QuotientKernel {
+public:
+    using Row = QuotientGraph::Row;
+
+    explicit QuotientKernel(const QuotientGraph& quotient);
+
+    int getBlockCount() const { return kernel_count_; }
+    int getQuotientBlocks() const { return block_count_; }
+    int getQiOffset() const { return removed_count_ - universal_count_; }
+    int getUniversalBlocks() const { return universal_count_; }
+
+    // kernel adjacency over consecutive indices 0..getBlockCount()-1
+    template <int Words>
+    void copyAdjacency(BlockSet<Words>* adjacency) const;
+
+    // coloring by block label from a proper coloring of the kernel (by kernel index),
+    // re-adding the removed blocks in reverse order
+    void liftColoring(const int* kernel_colors, int* label_colors) const;
+
+    // clique grows greedily out of candidates (common neighbours of clique), each time by
+    // the candidate that keeps most candidates; the one clique heuristic behind every chi
+    // lower bound (kernel rules, bound estimates, branch and bound, SAT encoding)
+    template <int Words>
+    static BlockSet<Words> growClique(const BlockSet<Words>* adjacency, BlockSet<Words> clique,
+                                      BlockSet<Words> candidates);
+
+    // largest clique grown from each start block among the first count
+    template <int Words>
+    static BlockSet<Words> greedyClique(const BlockSet<Words>* adjacency, int count);
+
+private:
+    enum class Rule { Universal, Dominated, LowDegree };
+
+    int block_count_;
+    Row adjacency_[QuotientGraph::MAX_BLOCKS];  // by compact index
+    int block_labels_[QuotientGraph::MAX_BLOCKS];
+    Row alive_;
+
+    // kernel index -> compact index
+    int kernel_blocks_[QuotientGraph::MAX_BLOCKS];
+    int kernel_count_;
+
+    // removals, in order: block, rule and (dominated) the block whose color it takes
+    int removed_[QuotientGraph::MAX_BLOCKS];
+    Rule rule_[QuotientGraph::MAX_BLOCKS];
+    int partner_[QuotientGraph::MAX_BLOCKS];
+    int removed_count_;
+    int universal_count_;
+
+    Row greedyClique() const;
+    void remove(int block, Rule rule, int partner);
+};
+
+template <int Words>
+void QuotientKernel::copyAdjacency(BlockSet<Words>* adjacency) const {
+    for (int i = 0; i < kernel_count_; i++) {
+        const Row& row = adjacency_[kernel_blocks_[i]];
+        adjacency[i] = BlockSet<Words>::none();
+        for (int j = 0; j < kernel_count_; j++) {
+            if (row.test(kernel_blocks_[j])) adjacency[i].set(j);
+        }
+    }
+}
+
+template <int Words>
+BlockSet<Words> QuotientKernel::growClique(const BlockSet<Words>* adjacency, BlockSet<Words> clique,
+                                           BlockSet<Words> candidates) {
+    while (candidates.any()) {
+        BlockSet<Words> pool = candidates;
+        int next = -1;
+        int next_degree = -1;
+        for (int b = pool.popLowest(); b >= 0; b = pool.popLowest()) {
+            int degree = (adjacency[b] & candidates).count();
+            if (degree > next_degree) {
+                next_degree = degree;
+                next = b;
+            }
+        }
+        clique.set(next);
+        candidates = candidates & adjacency[next];
+    }
+    return clique;
+}
+
+template <int Words>
+BlockSet<Words> QuotientKernel::greedyClique(const BlockSet<Words>* adjacency, int count) {
+    BlockSet<Words> blocks = BlockSet<Words>::firstN(count);
+    BlockSet<Words> best = BlockSet<Words>::none();
+    for (int start = 0; start < count; start++) {
+        BlockSet<Words> clique = BlockSet<Words>::none();
+        clique.set(start);
+        clique = growClique(adjacency, clique, adjacency[start] & blocks);
+        if (clique.count() > best.count()) best = clique;
+    }
+    return best;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+// xoshiro256** generator: small state, fast, and fully determined by a 64-bit seed,
+// so any chain can be replayed from the seed printed in its report
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed) {
+        // expand the seed with splitmix64 as recommended by the xoshiro authors
+        for (int i = 0; i < 4; i++) {
+            state_[i] = splitMix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~uint64_t(0); }
+
+    result_type operator()() {
+        uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // uniform integer in [0, bound) (Lemire's multiply-shift with rejection)
+    uint32_t below(uint32_t bound) {
+        uint64_t product = (operator()() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                product = (operator()() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // seed of the independent stream used by chain number chain_index of a run
+    static uint64_t streamSeed(uint64_t base_seed, uint64_t chain_index) {
+        uint64_t mixed = base_seed ^ (chain_index * 0xd1342543de82ef95ULL);
+        return splitMix64(mixed);
+    }
+
+private:
+    uint64_t state_[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
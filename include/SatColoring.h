@@ -0,0 +1,34 @@
+#pragma once
+
+#include "QuotientGraph.h"
+#include "SatSolver.h"
+#include "SearchBudget.h"
+
+// the qi threshold as a SAT decision (QI_SAT_BACKEND): qi >= k - colors exactly when
+// the quotient has a proper coloring with at most colors colors. Variable x(b, c) puts
+// block b in color c; every block takes a color and adjacent blocks never share one.
+// Color symmetry is broken by ordering the blocks (a greedy clique first, then by
+// degree) and numbering colors by first use: the clique is fixed to colors 0..q-1 and
+// the block at position p only gets colors 0..p.
+class SatColoring {
+public:
+    using Row = QuotientGraph::Row;
+
+    SatColoring(const Row* adjacency, int block_count);
+
+    // Sat with a coloring by getColor, Unsat when none has at most colors colors, Unknown
+    // when budget (one unit per conflict) runs out first
+    SatSolver::Result decide(int colors, SearchBudget* budget);
+
+    int getColor(int block) const { return color_[block]; }
+    long long getConflicts() const { return conflicts_; }
+
+private:
+    const Row* adjacency_;
+    int block_count_;
+    int color_[QuotientGraph::MAX_BLOCKS];
+    long long conflicts_;
+
+    // blocks in encoding order, the greedy clique first; returns the clique size
+    int orderBlocks(int* order) const;
+};
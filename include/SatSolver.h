@@ -0,0 +1,108 @@
+#pragma once
+
+#include "SearchBudget.h"
+#include <cstdint>
+#include <vector>
+
+// small CDCL SAT solver behind the optional qi decision backend (QI_SAT_BACKEND): two
+// watched literals, first-UIP learning with clause minimisation, VSIDS branching with
+// phase saving, Luby restarts and deletion of the learnt clauses with the worst LBD.
+// Variables are numbered from 1 and literals are DIMACS style (v true, -v false).
+// Clauses may be added between solve calls; learnt clauses are kept across them.
+class SatSolver {
+public:
+    enum class Result { Sat, Unsat, Unknown };
+
+    SatSolver();
+
+    int newVariable();
+    int getNumVariables() const { return static_cast<int>(assigns_.size()); }
+
+    // false once the clauses are unsatisfiable without any search
+    bool addClause(const std::vector<int>& literals);
+
+    // Unknown when budget (charged one unit per conflict) runs out first
+    Result solve(SearchBudget* budget = nullptr);
+
+    // value of variable in the model of the last Sat result
+    bool modelValue(int variable) const { return model_[variable - 1] != 0; }
+
+    long long getConflicts() const { return conflicts_; }
+
+private:
+    static constexpr int RESTART_BASE = 100;   // conflicts per unit of the Luby sequence
+    static constexpr int MIN_LEARNTS = 2000;
+    static constexpr double VAR_DECAY = 0.95;
+
+    // value of a variable or literal: false, true or not yet assigned
+    static constexpr uint8_t VALUE_FALSE = 0;
+    static constexpr uint8_t VALUE_TRUE = 1;
+    static constexpr uint8_t VALUE_UNDEF = 2;
+
+    // literals inside are 2 * variable + negated, variables from 0
+    struct Clause {
+        std::vector<int> literals;  // [0] and [1] are watched
+        bool learnt;
+        int lbd;                    // distinct decision levels when learnt
+    };
+
+    // a clause watching a literal, and another of its literals: while that one is true
+    // the clause is satisfied and need not be visited. A binary clause's blocker is its
+    // other literal, so it propagates without being visited at all.
+    struct Watch {
+        int clause;
+        int blocker;
+        bool binary;
+    };
+
+    bool ok_;
+    std::vector<Clause> clauses_;
+    std::vector<std::vector<Watch>> watches_;   // per literal: clauses watching it
+    std::vector<uint8_t> assigns_;
+    std::vector<uint8_t> model_;
+    std::vector<int> level_;
+    std::vector<int> reason_;                   // implying clause, -1 for decisions
+    std::vector<int> trail_;
+    std::vector<int> trail_lim_;                // trail size at each decision
+    size_t qhead_;
+
+    // branching: activity max-heap of variables, saved phases
+    std::vector<double> activity_;
+    double var_inc_;
+    std::vector<int> heap_;
+    std::vector<int> heap_index_;               // -1 when out of the heap
+    std::vector<uint8_t> polarity_;             // 1: branch on the negative literal
+
+    // conflict analysis scratch
+    std::vector<uint8_t> seen_;
+    std::vector<int> level_stamp_;                // one per decision level
+    int stamp_;
+
+    long long conflicts_;
+    int learnts_;
+    int max_learnts_;
+    int restarts_;
+
+    uint8_t value(int literal) const {
+        uint8_t assign = assigns_[literal >> 1];
+        return (assign == VALUE_UNDEF) ? VALUE_UNDEF : static_cast<uint8_t>(assign ^ (literal & 1));
+    }
+    int decisionLevel() const { return static_cast<int>(trail_lim_.size()); }
+
+    void enqueue(int literal, int reason);
+    int propagate();
+    void analyze(int conflict, std::vector<int>& learnt, int& backtrack_level, int& lbd);
+    bool redundant(int literal) const;
+    void cancelUntil(int level);
+    void attach(int clause);
+    void reduceLearnts();
+    int pickBranch();
+    Result search(int max_conflicts, SearchBudget* budget);
+
+    void bumpVariable(int variable);
+    void heapInsert(int variable);
+    int heapPop();
+    void heapUp(int position);
+    void heapDown(int position);
+    bool before(int a, int b) const { return activity_[a] > activity_[b]; }
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+// cooperative limit on one qi search: a node count and/or a wall-clock deadline.
+// Solvers charge one unit per search node and unwind once it runs out, returning
+// whatever bounds they have proven so far instead of being killed from outside.
+class SearchBudget {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // no limit at all
+    SearchBudget() : max_nodes_(0), deadline_(Clock::time_point::max()), nodes_(0), exhausted_(false) {}
+
+    // max_nodes <= 0 leaves the node count unlimited
+    SearchBudget(long long max_nodes, Clock::time_point deadline)
+        : max_nodes_(max_nodes), deadline_(deadline), nodes_(0), exhausted_(false) {}
+
+    // deadline max_seconds from now (<= 0 for none)
+    static SearchBudget fromNow(long long max_nodes, double max_seconds) {
+        Clock::time_point deadline = Clock::time_point::max();
+        if (max_seconds > 0) {
+            deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(max_seconds));
+        }
+        return SearchBudget(max_nodes, deadline);
+    }
+
+    // count one search node; true once the budget is spent (and from then on).
+    // The clock is only read every CLOCK_INTERVAL nodes to keep this cheap.
+    bool charge() {
+        if (exhausted_) return true;
+        nodes_++;
+        if (max_nodes_ > 0 && nodes_ >= max_nodes_) {
+            exhausted_ = true;
+        } else if ((nodes_ & (CLOCK_INTERVAL - 1)) == 0 && Clock::now() >= deadline_) {
+            exhausted_ = true;
+        }
+        return exhausted_;
+    }
+
+    // budget for one of parts workers splitting what is left of this one: the same
+    // deadline and an equal share of the remaining nodes
+    SearchBudget share(int parts) const {
+        long long max_nodes = 0;
+        if (max_nodes_ > 0) max_nodes = std::max(1LL, (max_nodes_ - nodes_) / parts);
+        return SearchBudget(max_nodes, deadline_);
+    }
+
+    // charge what a worker spent from its share back to this budget
+    void settle(const SearchBudget& part) {
+        nodes_ += part.nodes_;
+        if (part.exhausted_) exhausted_ = true;
+    }
+
+    bool isExhausted() const { return exhausted_; }
+    long long getNodes() const { return nodes_; }
+    Clock::time_point getDeadline() const { return deadline_; }
+
+private:
+    static const long long CLOCK_INTERVAL = 1024;
+
+    long long max_nodes_;
+    Clock::time_point deadline_;
+    long long nodes_;
+    bool exhausted_;
+};
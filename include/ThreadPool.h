@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads, started once and parked between calls, that share out
+// independent indexed tasks
+class ThreadPool {
+public:
+    // num_threads <= 0 uses every hardware thread
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // threads a pool of num_threads would run, without starting any
+    static int resolveThreads(int num_threads);
+
+    int getNumThreads() const { return num_threads_; }
+
+    // run task(index, worker) for every index in [0, count); indices are handed out
+    // dynamically so long and short tasks balance across workers. The calling thread
+    // acts as worker 0; one call at a time per pool.
+    void parallelFor(int count, const std::function<void(int index, int worker)>& task);
+
+private:
+    int num_threads_;
+    std::vector<std::thread> threads_;
+
+    // the current call, published under mutex_ by bumping generation_
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(int, int)>* task_;
+    int count_;
+    std::atomic<int> next_index_;
+    long long generation_;
+    int busy_;          // workers still on the current call
+    bool stopping_;
+
+    void runTasks(int worker);
+    void workerLoop(int worker);
+};
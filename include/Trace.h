@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+// subsystems that can be traced independently
+enum class TraceCategory {
+    Qi,         // Partition's qi calculations: algorithm choice, bounds, quotient dumps
+    Search,     // the exact and branch and bound solvers
+    Mc,         // Mc operations chosen by the chains
+    Count
+};
+
+enum class TraceLevel {
+    Off,
+    Info,       // one line per decision
+    Debug,      // one line per solver call
+    Detail      // per search node or quotient dump
+};
+
+// runtime-selectable diagnostics. Each category has a level, all off unless a spec
+// turns them on; a disabled trace point costs one load and a branch. Messages are
+// formatted into a buffer and written to the sink in large chunks (and at exit), so
+// tracing one graph in detail does not go through stdout line by line.
+class Trace {
+public:
+    // comma-separated "category[:level]" items, e.g. "qi:debug,search:detail" or
+    // "all:info"; a bare category means debug. Returns false with a message in error.
+    static bool configure(const std::string& spec, std::string& error);
+
+    // send output to a file instead of stderr
+    static bool setSink(const std::string& path, std::string& error);
+
+    static bool enabled(TraceCategory category, TraceLevel level) {
+        return levels_[static_cast<int>(category)] >= static_cast<int>(level);
+    }
+
+    // printf-style message, appended whole even when several threads trace at once
+    static void write(const char* format, ...);
+
+    static void flush();
+
+private:
+    static int levels_[static_cast<int>(TraceCategory::Count)];
+};
+
+#define QI_TRACE(category, level, ...)                                          \
+    do {                                                                        \
+        if (Trace::enabled(TraceCategory::category, TraceLevel::level)) {       \
+            Trace::write(__VA_ARGS__);                                          \
+        }                                                                       \
+    } while (0)
@@ -7,7 +7,7 @@ This script generates:
 2. Robertson configurations (633 graphs from source file)
 
 Usage:
-    python generate_all.py [--no-robertson] [--base-dir DIRECTORY]
+    python generate_all.py [--no-robertson] [--base-dir DIRECTORY] [--binary]
 """
 
 import argparse
@@ -20,11 +20,13 @@ def main():
                        help="Skip Robertson configuration generation")
     parser.add_argument("--base-dir", default="../graphs",
                        help="Base directory for graph files (default: ../graphs)")
+    parser.add_argument("--binary", action="store_true",
+                       help="Also write binary .qig copies, which qi_validate loads without parsing")
     
     args = parser.parse_args()
     
     # Create generator
-    generator = GraphGenerator()
+    generator = GraphGenerator(binary=args.binary)
     
     # Generate full test suite
     include_robertson = not args.no_robertson
@@ -5,20 +5,23 @@ Graph generator for qi validation testing.
 import networkx as nx
 from typing import List, Dict, Any
 import os
+import struct
 
 
 class GraphGenerator:
     """Generator for various types of graphs used in qi validation."""
     
-    def __init__(self, seed: int = 42):
+    def __init__(self, seed: int = 42, binary: bool = False):
         """
         Initialize GraphGenerator with deterministic seed.
         
         Args:
             seed: Random seed for deterministic graph generation
+            binary: Also write a binary .qig copy next to every .txt graph
         """
         self.graphs = {}
         self.seed = seed
+        self.binary = binary
         # Set seed for deterministic generation if needed
         import random
         random.seed(seed)
@@ -57,6 +60,34 @@ class GraphGenerator:
             
             # Write critical k
             f.write(f"k={critical_k}\n")
+        
+        if self.binary:
+            self.save_as_qi_binary(graph, os.path.splitext(filename)[0] + ".qig", critical_k)
+    
+    def save_as_qi_binary(self, graph: nx.Graph, filename: str, critical_k: int):
+        """
+        Save a graph in qi_validate's binary format, which loads without parsing.
+        
+        Layout (little-endian): b"QIG1", uint32 vertices, int32 critical k,
+        uint32 words per row, then one bit row of uint64 words per vertex.
+        
+        Args:
+            graph: NetworkX graph to save (nodes labelled 0..n-1)
+            filename: Output filename
+            critical_k: Critical k value for the graph
+        """
+        n = graph.number_of_nodes()
+        words = (n + 63) // 64
+        rows = [0] * n
+        for u, v in graph.edges():
+            if u != v:
+                rows[u] |= 1 << v
+                rows[v] |= 1 << u
+        
+        with open(filename, 'wb') as f:
+            f.write(struct.pack('<4sIiI', b'QIG1', n, critical_k, words))
+            for row in rows:
+                f.write(row.to_bytes(8 * words, 'little'))
     
     def generate_test_graphs(self, base_dir: str = "graphs"):
         """
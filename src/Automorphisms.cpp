@@ -0,0 +1,107 @@
+#include "../include/Automorphisms.h"
+#include <algorithm>
+#include <map>
+
+Automorphisms::Automorphisms(const Graph& graph, int max_order)
+    : graph_(graph), n_(graph.num_vertices), max_order_(std::max(1, max_order)), order_(0), fixed_(0) {
+    refineColours();
+    chooseSearchOrder();
+
+    // fix one more vertex of the search order each time the group is too large; with
+    // every vertex fixed only the identity is left, so this always ends
+    for (fixed_ = 0; fixed_ <= n_; fixed_++) {
+        order_ = 0;
+        images_.clear();
+        image_.assign(n_, -1);
+        used_.assign(n_, false);
+        if (extend(0)) break;
+    }
+
+    // identity first, then the inverses
+    for (int g = 0; g < order_; g++) {
+        const int* images = getImages(g);
+        bool identity = true;
+        for (int v = 0; v < n_ && identity; v++) identity = images[v] == v;
+        if (identity) {
+            std::swap_ranges(images_.begin(), images_.begin() + n_, images_.begin() + static_cast<size_t>(g) * n_);
+            break;
+        }
+    }
+    inverses_.resize(images_.size());
+    for (int g = 0; g < order_; g++) {
+        const int* images = getImages(g);
+        for (int v = 0; v < n_; v++) inverses_[static_cast<size_t>(g) * n_ + images[v]] = v;
+    }
+}
+
+// colour refinement: a vertex's colour is its old colour plus the multiset of its
+// neighbours' colours, until the classes stop splitting. Automorphisms preserve it.
+void Automorphisms::refineColours() {
+    colour_.assign(n_, 0);
+    int classes = n_ > 0 ? 1 : 0;
+    while (true) {
+        std::map<std::vector<int>, int> ranks;
+        std::vector<std::vector<int>> signatures(n_);
+        for (int v = 0; v < n_; v++) {
+            std::vector<int>& signature = signatures[v];
+            const int* neighbours = graph_.getNeighbours(v);
+            for (int i = 0; i < graph_.getDegree(v); i++) signature.push_back(colour_[neighbours[i]]);
+            std::sort(signature.begin(), signature.end());
+            signature.insert(signature.begin(), colour_[v]);
+            ranks.emplace(signature, 0);
+        }
+        int rank = 0;
+        for (auto& entry : ranks) entry.second = rank++;
+        for (int v = 0; v < n_; v++) colour_[v] = ranks[signatures[v]];
+        if (rank == classes) break;
+        classes = rank;
+    }
+}
+
+// map vertices joined to many already-mapped ones early, so adjacency prunes soon
+void Automorphisms::chooseSearchOrder() {
+    search_order_.clear();
+    std::vector<int> mapped_neighbours(n_, 0);
+    std::vector<bool> ordered(n_, false);
+    for (int step = 0; step < n_; step++) {
+        int next = -1;
+        for (int v = 0; v < n_; v++) {
+            if (!ordered[v] && (next < 0 || mapped_neighbours[v] > mapped_neighbours[next])) next = v;
+        }
+        ordered[next] = true;
+        search_order_.push_back(next);
+        const int* neighbours = graph_.getNeighbours(next);
+        for (int i = 0; i < graph_.getDegree(next); i++) mapped_neighbours[neighbours[i]]++;
+    }
+}
+
+// map search_order_[depth..] in every way that keeps adjacency with the vertices
+// mapped so far; false once more than max_order_ automorphisms exist
+bool Automorphisms::extend(int depth) {
+    if (depth == n_) {
+        if (order_ == max_order_) return false;
+        images_.insert(images_.end(), image_.begin(), image_.end());
+        order_++;
+        return true;
+    }
+
+    int v = search_order_[depth];
+    int first = (depth < fixed_) ? v : 0;
+    int last = (depth < fixed_) ? v : n_ - 1;
+    for (int w = first; w <= last; w++) {
+        if (used_[w] || colour_[w] != colour_[v]) continue;
+        bool consistent = true;
+        for (int i = 0; i < depth && consistent; i++) {
+            int u = search_order_[i];
+            consistent = graph_.hasEdge(v, u) == graph_.hasEdge(w, image_[u]);
+        }
+        if (!consistent) continue;
+
+        image_[v] = w;
+        used_[w] = true;
+        bool within_limit = extend(depth + 1);
+        used_[w] = false;
+        if (!within_limit) return false;
+    }
+    return true;
+}
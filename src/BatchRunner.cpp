@@ -0,0 +1,322 @@
+#include "../include/BatchRunner.h"
+#include "../include/ChainRunner.h"
+#include "../include/Graph.h"
+#include "../include/Partition.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// position just past "key": in line, or npos
+size_t findKey(const std::string& line, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    return pos == std::string::npos ? pos : pos + pattern.size();
+}
+
+// a string written by jsonString
+bool readString(const std::string& line, const char* key, std::string& value) {
+    size_t pos = findKey(line, key);
+    if (pos == std::string::npos || line[pos] != '"') return false;
+    value.clear();
+    for (pos++; pos < line.size(); pos++) {
+        char c = line[pos];
+        if (c == '"') return true;
+        if (c == '\\' && pos + 1 < line.size()) {
+            c = line[++pos];
+            if (c == 'u' && pos + 4 < line.size()) {
+                c = static_cast<char>(std::strtol(line.substr(pos + 1, 4).c_str(), nullptr, 16));
+                pos += 4;
+            }
+        }
+        value += c;
+    }
+    return false;
+}
+
+bool readNumber(const std::string& line, const char* key, double& value) {
+    size_t pos = findKey(line, key);
+    if (pos == std::string::npos) return false;
+    char* end;
+    value = std::strtod(line.c_str() + pos, &end);
+    return end != line.c_str() + pos;
+}
+
+bool readUnsigned(const std::string& line, const char* key, uint64_t& value) {
+    size_t pos = findKey(line, key);
+    if (pos == std::string::npos) return false;
+    char* end;
+    value = std::strtoull(line.c_str() + pos, &end, 10);
+    return end != line.c_str() + pos;
+}
+
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(int num_threads, uint64_t base_seed, double time_budget_seconds)
+    : num_threads_(num_threads), base_seed_(base_seed), time_budget_seconds_(time_budget_seconds),
+      step_nodes_(0), step_seconds_(0), policy_(MergePolicy::Uniform), beam_width_(1), shard_index_(0), num_shards_(1), resume_(false) {}
+
+void BatchRunner::setStepBudget(long long max_nodes, double max_seconds) {
+    step_nodes_ = max_nodes;
+    step_seconds_ = max_seconds;
+}
+
+void BatchRunner::setMergePolicy(MergePolicy policy, int beam_width) {
+    policy_ = policy;
+    beam_width_ = beam_width;
+}
+
+void BatchRunner::setShard(int shard_index, int num_shards) {
+    shard_index_ = shard_index;
+    num_shards_ = num_shards;
+}
+
+void BatchRunner::setCheckpoint(const std::string& path, bool resume) {
+    checkpoint_path_ = path;
+    resume_ = resume;
+}
+
+bool BatchRunner::collectGraphFiles(const std::string& path, std::vector<std::string>& files,
+                                    std::string& error) {
+    namespace fs = std::filesystem;
+    files.clear();
+    std::error_code ec;
+
+    if (fs::is_directory(path, ec)) {
+        // same selection as test_runner.py: every .txt that is not a README, except that
+        // a binary .qig copy next to a .txt is loaded in its place
+        for (fs::recursive_directory_iterator it(path, ec), end; it != end; it.increment(ec)) {
+            if (ec) break;
+            if (!it->is_regular_file()) continue;
+            std::string name = it->path().filename().string();
+            if (it->path().extension() == ".txt" && name.rfind("README", 0) != 0) {
+                fs::path binary = it->path();
+                binary.replace_extension(".qig");
+                if (!fs::exists(binary, ec)) files.push_back(it->path().string());
+            } else if (it->path().extension() == ".qig") {
+                files.push_back(it->path().string());
+            }
+        }
+        if (ec) {
+            error = "Could not read directory " + path + ": " + ec.message();
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+        return true;
+    }
+
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+        error = "Could not open batch manifest " + path;
+        return false;
+    }
+    fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        fs::path entry(line);
+        files.push_back(entry.is_absolute() ? entry.string() : (base / entry).string());
+    }
+    return true;
+}
+
+BatchEntry BatchRunner::validateGraph(const std::string& file, uint64_t seed) const {
+    auto start = std::chrono::steady_clock::now();
+    BatchEntry entry;
+    entry.graph = file;
+    entry.seed = seed;
+
+    // load problems go into the entry: this runs on a worker thread
+    Graph graph;
+    std::string load_error;
+    std::string load_warning;
+    if (!graph.loadFromFile(file.c_str(), load_error, load_warning)) {
+        entry.result = "ERROR";
+        entry.detail = "Failed to load graph: " + load_error;
+        return entry;
+    }
+    entry.vertices = graph.num_vertices;
+    entry.critical_k = graph.critical_k;
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (time_budget_seconds_ > 0) {
+        deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double>(time_budget_seconds_));
+    }
+
+    // the same chain a single-graph run with --seed would follow
+    ChainRunner runner(graph);
+    runner.setStepBudget(step_nodes_, step_seconds_);
+    runner.setMergePolicy(policy_, beam_width_);
+    Xoshiro256 rng(seed);
+    std::vector<StepTally> tallies(graph.num_vertices + 1);
+    ChainResult chain = runner.runChain(rng, tallies, deadline);
+    entry.steps = chain.steps;
+
+    if (chain.failed) {
+        entry.result = "FAIL";
+        entry.detail = "qi below required threshold at step " + std::to_string(chain.steps);
+    } else if (chain.timed_out) {
+        entry.result = "TIMEOUT";
+        entry.detail = "Time budget exhausted after " + std::to_string(chain.steps) + " steps";
+    } else if (chain.final_undetermined) {
+        entry.result = "PARTIAL";
+        entry.detail = "Final qi undetermined - quotient graph too large";
+    } else {
+        entry.result = "PASS";
+        entry.detail = "qi ≥ k - k' + 1 throughout process";
+    }
+    if (!load_warning.empty()) entry.detail += " (" + load_warning + ")";
+    entry.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return entry;
+}
+
+bool BatchRunner::run(const std::vector<std::string>& files, std::vector<BatchEntry>& entries,
+                      std::string& error) const {
+    // graphs finished by an earlier run, by path (a later line wins)
+    std::map<std::string, BatchEntry> done;
+    if (!checkpoint_path_.empty() && resume_ && std::filesystem::exists(checkpoint_path_)) {
+        std::vector<BatchEntry> finished;
+        if (!readJsonLines(checkpoint_path_, finished, error)) return false;
+        for (BatchEntry& entry : finished) done[entry.graph] = std::move(entry);
+    }
+
+    std::ofstream checkpoint;
+    if (!checkpoint_path_.empty()) {
+        // a line cut short by a crash stays on its own, ahead of the new ones
+        bool torn = false;
+        if (resume_) {
+            std::ifstream tail(checkpoint_path_, std::ios::binary | std::ios::ate);
+            if (tail.is_open() && tail.tellg() > 0) {
+                tail.seekg(-1, std::ios::end);
+                torn = tail.get() != '\n';
+            }
+        }
+        checkpoint.open(checkpoint_path_, resume_ ? std::ios::app : std::ios::trunc);
+        if (!checkpoint.is_open()) {
+            error = "Could not write to checkpoint file " + checkpoint_path_;
+            return false;
+        }
+        if (torn) checkpoint << '\n';
+    }
+    std::mutex checkpoint_mutex;
+
+    std::vector<int> shard;
+    for (int index = shard_index_; index < static_cast<int>(files.size()); index += num_shards_) {
+        shard.push_back(index);
+    }
+    entries.assign(shard.size(), BatchEntry());
+
+    ThreadPool pool(num_threads_);
+    pool.parallelFor(static_cast<int>(shard.size()), [&](int position, int) {
+        int index = shard[position];
+        uint64_t seed = Xoshiro256::streamSeed(base_seed_, static_cast<uint64_t>(index));
+        auto it = done.find(files[index]);
+        if (it != done.end() && it->second.seed == seed) {
+            entries[position] = it->second;
+            return;
+        }
+        entries[position] = validateGraph(files[index], seed);
+        if (checkpoint.is_open()) {
+            // one flushed line per graph, so a crash loses at most the graphs in flight
+            std::lock_guard<std::mutex> lock(checkpoint_mutex);
+            writeJsonLines(checkpoint, {entries[position]});
+            checkpoint.flush();
+        }
+    });
+
+    if (checkpoint.is_open() && !checkpoint) {
+        error = "Could not write to checkpoint file " + checkpoint_path_;
+        return false;
+    }
+    return true;
+}
+
+void BatchRunner::writeJsonLines(std::ostream& out, const std::vector<BatchEntry>& entries) {
+    for (const BatchEntry& entry : entries) {
+        out << "{\"graph\":" << jsonString(entry.graph)
+            << ",\"vertices\":" << entry.vertices
+            << ",\"critical_k\":" << entry.critical_k
+            << ",\"seed\":" << entry.seed
+            << ",\"steps\":" << entry.steps
+            << ",\"result\":" << jsonString(entry.result)
+            << ",\"detail\":" << jsonString(entry.detail)
+            << ",\"seconds\":" << std::fixed << std::setprecision(3) << entry.seconds
+            << "}\n";
+    }
+}
+
+void BatchRunner::writeCsv(std::ostream& out, const std::vector<BatchEntry>& entries) {
+    out << "graph,vertices,critical_k,seed,steps,result,detail,seconds\n";
+    for (const BatchEntry& entry : entries) {
+        out << csvField(entry.graph) << ',' << entry.vertices << ',' << entry.critical_k << ','
+            << entry.seed << ',' << entry.steps << ',' << entry.result << ','
+            << csvField(entry.detail) << ',' << std::fixed << std::setprecision(3) << entry.seconds
+            << '\n';
+    }
+}
+
+bool BatchRunner::readJsonLines(const std::string& path, std::vector<BatchEntry>& entries,
+                                std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "Could not open batch results file " + path;
+        return false;
+    }
+    entries.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        BatchEntry entry;
+        double vertices, critical_k, steps;
+        if (line.back() != '}' || !readString(line, "graph", entry.graph) ||
+            !readNumber(line, "vertices", vertices) || !readNumber(line, "critical_k", critical_k) ||
+            !readUnsigned(line, "seed", entry.seed) || !readNumber(line, "steps", steps) ||
+            !readString(line, "result", entry.result) || !readString(line, "detail", entry.detail) ||
+            !readNumber(line, "seconds", entry.seconds)) {
+            continue;
+        }
+        entry.vertices = static_cast<int>(vertices);
+        entry.critical_k = static_cast<int>(critical_k);
+        entry.steps = static_cast<int>(steps);
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
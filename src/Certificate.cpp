@@ -0,0 +1,271 @@
+#include "../include/Certificate.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// position just past "key": in line, or npos
+size_t findKey(const std::string& line, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    return pos == std::string::npos ? pos : pos + pattern.size();
+}
+
+bool readInt(const std::string& line, const char* key, long long& value) {
+    size_t pos = findKey(line, key);
+    if (pos == std::string::npos) return false;
+    char* end;
+    value = std::strtoll(line.c_str() + pos, &end, 10);
+    return end != line.c_str() + pos;
+}
+
+bool readIntArray(const std::string& line, const char* key, std::vector<int>& values) {
+    values.clear();
+    size_t pos = findKey(line, key);
+    if (pos == std::string::npos || line[pos] != '[') return false;
+    const char* cursor = line.c_str() + pos + 1;
+    if (*cursor == ']') return true;
+    while (true) {
+        char* end;
+        long value = std::strtol(cursor, &end, 10);
+        if (end == cursor) return false;
+        values.push_back(static_cast<int>(value));
+        if (*end == ']') return true;
+        if (*end != ',') return false;
+        cursor = end + 1;
+    }
+}
+
+// union-find root of x, halving the path on the way
+int findRoot(std::vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+} // namespace
+
+bool CertificateWriter::open(const std::string& path, const std::string& graph_file, const Graph& graph,
+                             uint64_t seed) {
+    out_.open(path);
+    if (!out_.is_open()) return false;
+    out_ << "{\"graph\":" << jsonString(graph_file) << ",\"vertices\":" << graph.num_vertices
+         << ",\"critical_k\":" << graph.critical_k << ",\"seed\":" << seed << "}\n";
+    steps_written_ = 0;
+    return true;
+}
+
+void CertificateWriter::writeStep(int step, const Partition& partition) {
+    int n = partition.getNumVertices();
+    std::vector<int> label_colors(n, -1);
+    if (!partition.getWitnessCover(label_colors.data())) {
+        for (int label = 0; label < n; label++) label_colors[label] = label;
+    }
+
+    // renumber colors by first appearance so the file only holds 0..c-1
+    std::vector<int> renumbered(n, -1);
+    int colors = 0;
+    std::string labels_text;
+    std::string cover_text;
+    for (int v = 0; v < n; v++) {
+        int label = partition.getLabel(v);
+        int& color = renumbered[label_colors[label]];
+        if (color < 0) color = colors++;
+        if (v > 0) {
+            labels_text += ',';
+            cover_text += ',';
+        }
+        labels_text += std::to_string(label);
+        cover_text += std::to_string(color);
+    }
+
+    out_ << "{\"step\":" << step << ",\"blocks\":" << partition.getNumBlocks() << ",\"colors\":" << colors
+         << ",\"labels\":[" << labels_text << "],\"cover\":[" << cover_text << "]}\n";
+    steps_written_++;
+}
+
+CertificateVerifier::CertificateVerifier(const Graph& graph)
+    : graph_(graph), steps_verified_(0), last_step_(-1), last_blocks_(0) {}
+
+// "3, 7-9" for the steps without a certificate
+std::string CertificateVerifier::formatMissingSteps() const {
+    std::string text;
+    for (size_t i = 0; i < missing_steps_.size();) {
+        size_t end = i + 1;
+        while (end < missing_steps_.size() && missing_steps_[end] == missing_steps_[end - 1] + 1) end++;
+        if (!text.empty()) text += ", ";
+        text += std::to_string(missing_steps_[i]);
+        if (end - i > 1) {
+            text += '-';
+            text += std::to_string(missing_steps_[end - 1]);
+        }
+        i = end;
+    }
+    return text;
+}
+
+bool CertificateVerifier::verify(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "Could not open certificate file " + path;
+        return false;
+    }
+    // every chain starts from the all-singletons partition at step 0, so the first
+    // certified step must be reachable from it
+    steps_verified_ = 0;
+    last_step_ = -1;
+    last_blocks_ = graph_.num_vertices;
+    last_labels_.resize(graph_.num_vertices);
+    for (int v = 0; v < graph_.num_vertices; v++) last_labels_[v] = v;
+    missing_steps_.clear();
+
+    std::string line;
+    long long vertices, critical_k;
+    if (!std::getline(in, line) || !readInt(line, "vertices", vertices) ||
+        !readInt(line, "critical_k", critical_k)) {
+        error = "Missing certificate header line";
+        return false;
+    }
+    if (vertices != graph_.num_vertices || critical_k != graph_.critical_k) {
+        error = "Certificate was written for a graph with " + std::to_string(vertices) +
+                " vertices and k'=" + std::to_string(critical_k);
+        return false;
+    }
+
+    std::vector<int> labels;
+    std::vector<int> cover;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        long long step, blocks, colors;
+        if (!readInt(line, "step", step) || !readInt(line, "blocks", blocks) ||
+            !readInt(line, "colors", colors) || !readIntArray(line, "labels", labels) ||
+            !readIntArray(line, "cover", cover)) {
+            error = "Malformed certificate line after step " + std::to_string(last_step_);
+            return false;
+        }
+        if (!verifyStep(static_cast<int>(step), static_cast<int>(blocks), static_cast<int>(colors),
+                        labels, cover, error)) {
+            error = "Step " + std::to_string(step) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CertificateVerifier::verifyStep(int step, int blocks, int colors, const std::vector<int>& labels,
+                                     const std::vector<int>& cover, std::string& error) {
+    int n = graph_.num_vertices;
+    if (static_cast<int>(labels.size()) != n || static_cast<int>(cover.size()) != n) {
+        error = "expected " + std::to_string(n) + " labels and colors";
+        return false;
+    }
+
+    // one color per block, and the counts the line claims
+    std::vector<int> block_color(n, -1);
+    std::vector<char> color_seen(n, 0);
+    int block_count = 0;
+    int color_count = 0;
+    for (int v = 0; v < n; v++) {
+        if (labels[v] < 0 || labels[v] >= n || cover[v] < 0 || cover[v] >= n) {
+            error = "label or color out of range at vertex " + std::to_string(v);
+            return false;
+        }
+        int& color = block_color[labels[v]];
+        if (color < 0) {
+            color = cover[v];
+            block_count++;
+        } else if (color != cover[v]) {
+            error = "block " + std::to_string(labels[v]) + " has more than one color";
+            return false;
+        }
+        if (!color_seen[cover[v]]) {
+            color_seen[cover[v]] = 1;
+            color_count++;
+        }
+    }
+    if (block_count != blocks || color_count != colors) {
+        error = "block or color count does not match the labels";
+        return false;
+    }
+
+    // proper coloring of the quotient: no edge joins two blocks of the same color
+    for (int u = 0; u < n; u++) {
+        const int* neighbours = graph_.getNeighbours(u);
+        for (int i = 0, degree = graph_.getDegree(u); i < degree; i++) {
+            int v = neighbours[i];
+            if (v > u && labels[u] != labels[v] && cover[u] == cover[v]) {
+                error = "blocks " + std::to_string(labels[u]) + " and " + std::to_string(labels[v]) +
+                        " are adjacent but share a color";
+                return false;
+            }
+        }
+    }
+
+    int required_qi = blocks - graph_.critical_k + 1;
+    if (blocks - colors < required_qi) {
+        error = "cover proves qi >= " + std::to_string(blocks - colors) + ", " +
+                std::to_string(required_qi) + " required";
+        return false;
+    }
+
+    // each merge (Mc operation) joins two blocks adjacent in the quotient, so the
+    // partition must coarsen the previous one by one block per step, and the previous
+    // blocks joined into each block must be connected in the previous quotient
+    int previous_step = std::max(last_step_, 0);
+    std::string previous = (last_step_ < 0) ? "the initial partition" : "step " + std::to_string(last_step_);
+    if (step < previous_step || (step == previous_step && last_step_ >= 0) ||
+        last_blocks_ - blocks != step - previous_step) {
+        error = "does not follow " + previous + " by merges";
+        return false;
+    }
+    std::vector<int> image(n, -1);
+    for (int v = 0; v < n; v++) {
+        int& mapped = image[last_labels_[v]];
+        if (mapped < 0) {
+            mapped = labels[v];
+        } else if (mapped != labels[v]) {
+            error = "splits a block of " + previous;
+            return false;
+        }
+    }
+    std::vector<int> parent(n);
+    for (int label = 0; label < n; label++) parent[label] = label;
+    int components = last_blocks_;
+    for (int u = 0; u < n; u++) {
+        const int* neighbours = graph_.getNeighbours(u);
+        for (int i = 0, degree = graph_.getDegree(u); i < degree; i++) {
+            int v = neighbours[i];
+            if (labels[u] != labels[v]) continue;
+            int a = findRoot(parent, last_labels_[u]);
+            int b = findRoot(parent, last_labels_[v]);
+            if (a != b) {
+                parent[a] = b;
+                components--;
+            }
+        }
+    }
+    if (components != blocks) {
+        error = "merges blocks of " + previous + " that are not adjacent in its quotient";
+        return false;
+    }
+    for (int missing = previous_step + (last_step_ >= 0 ? 1 : 0); missing < step; missing++) {
+        missing_steps_.push_back(missing);
+    }
+
+    last_labels_ = labels;
+    last_blocks_ = blocks;
+    last_step_ = step;
+    steps_verified_++;
+    return true;
+}
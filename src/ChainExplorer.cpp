@@ -0,0 +1,277 @@
+#include "../include/ChainExplorer.h"
+#include "../include/McOperations.h"
+#include "../include/Partition.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// canonical labels packed two bytes per vertex
+std::string encodeKey(const int* labels, int n) {
+    std::string key(2 * n, '\0');
+    for (int v = 0; v < n; v++) {
+        key[2 * v] = static_cast<char>(labels[v] & 0xff);
+        key[2 * v + 1] = static_cast<char>((labels[v] >> 8) & 0xff);
+    }
+    return key;
+}
+
+Partition decodeKey(const std::string& key, int num_vertices) {
+    int labels[Partition::MAX_VERTICES];
+    for (int v = 0; v < num_vertices; v++) {
+        labels[v] = static_cast<unsigned char>(key[2 * v]) |
+                    (static_cast<unsigned char>(key[2 * v + 1]) << 8);
+    }
+    return Partition(labels, num_vertices);
+}
+
+// count a whole orbit of partitions with the same qi
+void tallyQi(int qi, int required_qi, long long orbit_size, StepTally& tally) {
+    if (qi == -1) {
+        tally.undetermined += orbit_size;
+    } else if (qi < required_qi) {
+        tally.fail += orbit_size;
+    } else {
+        tally.pass += orbit_size;
+    }
+}
+
+const char CHECKPOINT_MAGIC[4] = {'Q', 'I', 'X', '1'};
+
+template <typename T>
+void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+ChainExplorer::ChainExplorer(const Graph& graph, bool use_symmetry)
+    : graph_(graph), group_(graph, use_symmetry ? Automorphisms::MAX_ORDER : 1), resumed_blocks_(0) {}
+
+// hash of k' and the adjacency rows, so a frontier is never resumed on another graph
+uint64_t ChainExplorer::fingerprint() const {
+    uint64_t hash = 0xcbf29ce484222325ULL ^ static_cast<uint64_t>(graph_.critical_k);
+    for (int v = 0; v < graph_.num_vertices; v++) {
+        const uint64_t* row = graph_.getAdjacencyRow(v);
+        for (int w = 0; w < graph_.getRowWords(); w++) hash = (hash ^ row[w]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// magic, vertex count, fingerprint, group order, level block count, state and orbit
+// totals, then per block count the tallies and states, then per orbit of the level its
+// key, qi and size. Written beside path and renamed over it, so a crash mid-write
+// leaves the previous frontier in place.
+void ChainExplorer::saveCheckpoint(int num_blocks, const ExplorationResult& result, const Level& level) const {
+    std::string temporary = checkpoint_path_ + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writeValue<int32_t>(out, graph_.num_vertices);
+        writeValue<uint64_t>(out, fingerprint());
+        writeValue<int32_t>(out, result.group_order);
+        writeValue<int32_t>(out, num_blocks);
+        writeValue<int64_t>(out, result.total_states);
+        writeValue<int64_t>(out, result.total_orbits);
+        for (int size = 0; size <= graph_.num_vertices; size++) {
+            writeValue<int64_t>(out, result.tallies[size].pass);
+            writeValue<int64_t>(out, result.tallies[size].fail);
+            writeValue<int64_t>(out, result.tallies[size].undetermined);
+            writeValue<int64_t>(out, result.states[size]);
+        }
+        writeValue<uint64_t>(out, level.size());
+        for (const auto& entry : level) {
+            out.write(entry.first.data(), entry.first.size());
+            writeValue<int32_t>(out, entry.second.qi);
+            writeValue<int64_t>(out, entry.second.size);
+        }
+        if (!out) {
+            std::cout << "Warning: Could not write exploration checkpoint " << temporary << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, checkpoint_path_, ec);
+    if (ec) std::cout << "Warning: Could not replace exploration checkpoint " << checkpoint_path_ << std::endl;
+}
+
+bool ChainExplorer::resumeFrom(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return true;     // nothing saved yet: start from P*
+
+    int n = graph_.num_vertices;
+    char magic[4];
+    int32_t vertices, group_order, num_blocks;
+    uint64_t saved_fingerprint, level_size;
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        error = "Not an exploration checkpoint: " + path;
+        return false;
+    }
+    if (!readValue(in, vertices) || !readValue(in, saved_fingerprint) || !readValue(in, group_order) ||
+        vertices != n || saved_fingerprint != fingerprint()) {
+        error = "Exploration checkpoint " + path + " was written for another graph";
+        return false;
+    }
+    if (group_order != group_.getOrder()) {
+        error = "Exploration checkpoint " + path + " was written with " + std::to_string(group_order) +
+                " automorphisms, this run uses " + std::to_string(group_.getOrder());
+        return false;
+    }
+
+    ExplorationResult result;
+    result.tallies.assign(n + 1, StepTally());
+    result.states.assign(n + 1, 0);
+    result.group_order = group_order;
+    bool ok = readValue(in, num_blocks) && readValue(in, result.total_states) &&
+              readValue(in, result.total_orbits);
+    for (int size = 0; ok && size <= n; size++) {
+        ok = readValue(in, result.tallies[size].pass) && readValue(in, result.tallies[size].fail) &&
+             readValue(in, result.tallies[size].undetermined) && readValue(in, result.states[size]);
+    }
+    ok = ok && readValue(in, level_size);
+    Level level;
+    std::string key(2 * n, '\0');
+    for (uint64_t i = 0; ok && i < level_size; i++) {
+        OrbitState state;
+        ok = in.read(key.data(), key.size()) && readValue(in, state.qi) && readValue(in, state.size);
+        if (ok) level.emplace(key, state);
+    }
+    if (!ok || num_blocks < graph_.critical_k || num_blocks > n || level.empty()) {
+        error = "Truncated exploration checkpoint: " + path;
+        return false;
+    }
+
+    resumed_blocks_ = num_blocks;
+    resumed_result_ = std::move(result);
+    resumed_level_ = std::move(level);
+    return true;
+}
+
+// least canonical labelling over the partition's images under the group (a block's
+// image is labelled by its smallest image vertex); orbit_size = order / stabiliser
+std::string ChainExplorer::orbitKey(const Partition& partition, long long& orbit_size) const {
+    int n = partition.getNumVertices();
+    int labels[Partition::MAX_VERTICES];
+    int best[Partition::MAX_VERTICES];
+    int image[Partition::MAX_VERTICES];
+    int block_min[Partition::MAX_VERTICES];
+    partition.getCanonicalLabels(labels);
+    std::copy(labels, labels + n, best);
+
+    int stabiliser = 1; // the identity, element 0
+    for (int g = 1; g < group_.getOrder(); g++) {
+        const int* images = group_.getImages(g);
+        const int* inverse = group_.getInverse(g);
+        std::fill(block_min, block_min + n, n);
+        for (int v = 0; v < n; v++) block_min[labels[v]] = std::min(block_min[labels[v]], images[v]);
+        for (int w = 0; w < n; w++) image[w] = block_min[labels[inverse[w]]];
+
+        int order = 0;
+        for (int w = 0; w < n && order == 0; w++) order = (image[w] < best[w]) ? -1 : (image[w] > best[w]);
+        if (order < 0) {
+            std::copy(image, image + n, best);
+            stabiliser = 1;
+        } else if (order == 0) {
+            stabiliser++;
+        }
+    }
+    orbit_size = group_.getOrder() / stabiliser;
+    return encodeKey(best, n);
+}
+
+ExplorationResult ChainExplorer::explore() const {
+    int n = graph_.num_vertices;
+    ExplorationResult result;
+
+    // orbit key -> qi and orbit size for every orbit of the current level
+    Level level;
+    int num_blocks;
+    int required_qi;
+    long long orbit_size;
+
+    if (resumed_blocks_ > 0) {
+        result = resumed_result_;
+        level = resumed_level_;
+        num_blocks = resumed_blocks_;
+    } else {
+        result.tallies.assign(n + 1, StepTally());
+        result.states.assign(n + 1, 0);
+        result.group_order = group_.getOrder();
+
+        // Create initial partition P* (each vertex in its own block)
+        int initial_partition[Partition::MAX_VERTICES];
+        for (int i = 0; i < n; i++) {
+            initial_partition[i] = i;
+        }
+        Partition start(initial_partition, n);
+        num_blocks = start.getNumBlocks();
+        required_qi = num_blocks - graph_.critical_k + 1;
+        start.calculateQiNumber(graph_, required_qi);
+        // orbitKey sets orbit_size, so it runs before the state reads it
+        std::string start_key = orbitKey(start, orbit_size);
+        level.emplace(std::move(start_key), OrbitState{start.getQiNumber(), orbit_size});
+        tallyQi(start.getQiNumber(), required_qi, orbit_size, result.tallies[num_blocks]);
+        result.states[num_blocks] = orbit_size;
+        result.total_states = orbit_size;
+        result.total_orbits = 1;
+        if (!checkpoint_path_.empty()) saveCheckpoint(num_blocks, result, level);
+    }
+
+    // candidate merges, refilled per state and grown only when a state needs more
+    std::vector<int> block1_array;
+    std::vector<int> block2_array;
+
+    // children are visited by merging in place and undoing, never by copying the parent
+    MergeLog log;
+    log.reserve(1);
+
+    while (num_blocks > graph_.critical_k) {
+        Level next_level;
+        required_qi = (num_blocks - 1) - graph_.critical_k + 1;
+
+        for (const auto& entry : level) {
+            Partition partition = decodeKey(entry.first, n);
+            int num_operations = McOperations::findAllMcOperations(partition, graph_, block1_array, block2_array);
+            for (int i = 0; i < num_operations; i++) {
+                partition.mergeBlocks(block1_array[i], block2_array[i], log);
+                std::string child_key = orbitKey(partition, orbit_size);
+                if (!next_level.count(child_key)) { // else reached via another merge order or symmetry
+                    partition.calculateQiNumber(graph_, required_qi);
+                    tallyQi(partition.getQiNumber(), required_qi, orbit_size, result.tallies[num_blocks - 1]);
+                    next_level.emplace(std::move(child_key), OrbitState{partition.getQiNumber(), orbit_size});
+                }
+                partition.undoMerge(log);
+            }
+        }
+
+        if (next_level.empty()) break; // No more Mc operations available
+
+        level.swap(next_level);
+        num_blocks--;
+        for (const auto& entry : level) result.states[num_blocks] += entry.second.size;
+        result.total_states += result.states[num_blocks];
+        result.total_orbits += static_cast<long long>(level.size());
+        if (!checkpoint_path_.empty()) saveCheckpoint(num_blocks, result, level);
+    }
+
+    // like a single chain, P* itself is only judged when no merge follows it
+    result.final_blocks = num_blocks;
+    int last_judged = (result.final_blocks < n) ? n - 1 : n;
+    for (int size = result.final_blocks; size <= last_judged; size++) {
+        if (result.tallies[size].fail > 0) result.failed = true;
+    }
+    for (const auto& entry : level) {
+        if (entry.second.qi == -1) result.final_undetermined = true;
+    }
+    return result;
+}
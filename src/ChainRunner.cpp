@@ -0,0 +1,243 @@
+#include "../include/ChainRunner.h"
+#include "../include/McOperations.h"
+#include "../include/Partition.h"
+#include "../include/ThreadPool.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+// classify a partition's qi against the k - k' + 1 threshold
+void tallyStep(const Partition& partition, int required_qi, std::vector<StepTally>& tallies) {
+    StepTally& tally = tallies[partition.getNumBlocks()];
+    if (partition.getQiNumber() == -1) {
+        tally.undetermined++;
+    } else if (partition.getQiNumber() < required_qi) {
+        tally.fail++;
+    } else {
+        tally.pass++;
+    }
+}
+
+} // namespace
+
+ChainRunner::ChainRunner(const Graph& graph)
+    : graph_(graph), step_nodes_(0), step_seconds_(0), policy_(MergePolicy::Uniform), beam_width_(1) {}
+
+void ChainRunner::setStepBudget(long long max_nodes, double max_seconds) {
+    step_nodes_ = max_nodes;
+    step_seconds_ = max_seconds;
+}
+
+void ChainRunner::setMergePolicy(MergePolicy policy, int beam_width) {
+    policy_ = policy;
+    beam_width_ = std::max(1, beam_width);
+}
+
+SearchBudget ChainRunner::stepBudget(std::chrono::steady_clock::time_point deadline) const {
+    SearchBudget step = SearchBudget::fromNow(step_nodes_, step_seconds_);
+    return step.getDeadline() < deadline ? step : SearchBudget(step_nodes_, deadline);
+}
+
+ChainResult ChainRunner::runChain(Xoshiro256& rng, std::vector<StepTally>& tallies) const {
+    return runChain(rng, tallies, std::chrono::steady_clock::time_point::max());
+}
+
+ChainResult ChainRunner::runChain(Xoshiro256& rng, std::vector<StepTally>& tallies,
+                                  std::chrono::steady_clock::time_point deadline) const {
+    if (policy_ == MergePolicy::Beam) return runBeam(rng, tallies, deadline);
+    
+    ChainResult result;
+    QiCounters start_counters = QiCounters::local();
+    MergeSelector selector(graph_, policy_);
+
+    // Create initial partition P* (each vertex in its own block)
+    int initial_partition[Partition::MAX_VERTICES];
+    for (int i = 0; i < graph_.num_vertices; i++) {
+        initial_partition[i] = i;
+    }
+    Partition current_partition(initial_partition, graph_.num_vertices);
+
+    int required_qi = current_partition.getNumBlocks() - graph_.critical_k + 1;
+    SearchBudget budget = stepBudget(deadline);
+    current_partition.calculateQiNumber(graph_, required_qi, budget);
+    tallyStep(current_partition, required_qi, tallies);
+
+    // Perform Mc operations until we reach target size
+    while (current_partition.getNumBlocks() > graph_.critical_k) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            result.timed_out = true;
+            break;
+        }
+
+        // merge in place; the chain never needs the previous partition again
+        auto step_start = std::chrono::steady_clock::now();
+        int block1, block2;
+        if (!selector.choose(current_partition, rng, block1, block2)) {
+            break; // No more Mc operations available
+        }
+        current_partition.mergeBlocks(block1, block2);
+
+        required_qi = current_partition.getNumBlocks() - graph_.critical_k + 1;
+        budget = stepBudget(deadline);
+        current_partition.calculateQiNumber(graph_, required_qi, budget);
+        tallyStep(current_partition, required_qi, tallies);
+        result.steps++;
+        result.max_step_seconds = std::max(
+            result.max_step_seconds,
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count());
+        if (current_partition.getQiNumber() == -1) {
+            result.undecided_steps++;
+        }
+
+        if (current_partition.getQiNumber() != -1 && current_partition.getQiNumber() < required_qi) {
+            result.failed = true;
+            break;
+        }
+    }
+
+    result.counters = QiCounters::local() - start_counters;
+    result.final_blocks = current_partition.getNumBlocks();
+    result.final_undetermined = (current_partition.getQiNumber() == -1);
+
+    // like a single chain, P* itself is only judged when no merge follows it
+    if (result.steps == 0 && !result.final_undetermined) {
+        result.failed = current_partition.getQiNumber() < required_qi;
+    }
+    return result;
+}
+
+ChainResult ChainRunner::runBeam(Xoshiro256& rng, std::vector<StepTally>& tallies,
+                                 std::chrono::steady_clock::time_point deadline) const {
+    ChainResult result;
+    QiCounters start_counters = QiCounters::local();
+    int n = graph_.num_vertices;
+    
+    // Create initial partition P* (each vertex in its own block)
+    int initial_partition[Partition::MAX_VERTICES];
+    for (int i = 0; i < n; i++) {
+        initial_partition[i] = i;
+    }
+    std::vector<Partition> level(1, Partition(initial_partition, n));
+    
+    int required_qi = level[0].getNumBlocks() - graph_.critical_k + 1;
+    SearchBudget budget = stepBudget(deadline);
+    level[0].calculateQiNumber(graph_, required_qi, budget);
+    tallyStep(level[0], required_qi, tallies);
+    
+    // a child merge of the current level, ranked by its cheap interval (random tie break)
+    struct Candidate {
+        QiBounds score;
+        uint64_t tie;
+        int parent;
+        int block1;
+        int block2;
+    };
+    std::vector<Candidate> candidates;
+    std::unordered_set<std::string> seen;
+    std::vector<int> block1_array;
+    std::vector<int> block2_array;
+    int labels[Partition::MAX_VERTICES];
+    MergeLog log;
+    log.reserve(1);
+    
+    while (level[0].getNumBlocks() > graph_.critical_k) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            result.timed_out = true;
+            break;
+        }
+        auto step_start = std::chrono::steady_clock::now();
+        
+        // every distinct child of the level, merged on a copy of its parent
+        candidates.clear();
+        seen.clear();
+        for (int parent = 0; parent < static_cast<int>(level.size()); parent++) {
+            Partition scratch = level[parent];
+            int num_operations = McOperations::findAllMcOperations(scratch, graph_, block1_array, block2_array);
+            for (int i = 0; i < num_operations; i++) {
+                scratch.mergeBlocks(block1_array[i], block2_array[i], log);
+                scratch.getCanonicalLabels(labels);
+                if (seen.emplace(reinterpret_cast<const char*>(labels), n * sizeof(int)).second) {
+                    candidates.push_back({scratch.estimateQiBounds(graph_), rng(), parent,
+                                          block1_array[i], block2_array[i]});
+                }
+                scratch.undoMerge(log);
+            }
+        }
+        if (candidates.empty()) break; // No more Mc operations available
+        
+        int width = std::min(beam_width_, static_cast<int>(candidates.size()));
+        std::partial_sort(candidates.begin(), candidates.begin() + width, candidates.end(),
+                          [](const Candidate& a, const Candidate& b) {
+                              if (a.score.upper != b.score.upper) return a.score.upper < b.score.upper;
+                              if (a.score.lower != b.score.lower) return a.score.lower < b.score.lower;
+                              return a.tie < b.tie;
+                          });
+        
+        std::vector<Partition> next_level;
+        next_level.reserve(width);
+        required_qi = level[0].getNumBlocks() - 1 - graph_.critical_k + 1;
+        for (int c = 0; c < width && !result.failed; c++) {
+            next_level.push_back(level[candidates[c].parent]);
+            Partition& child = next_level.back();
+            child.mergeBlocks(candidates[c].block1, candidates[c].block2);
+            budget = stepBudget(deadline);
+            child.calculateQiNumber(graph_, required_qi, budget);
+            tallyStep(child, required_qi, tallies);
+            if (child.getQiNumber() == -1) {
+                result.undecided_steps++;
+            } else if (child.getQiNumber() < required_qi) {
+                result.failed = true;
+            }
+        }
+        level.swap(next_level);
+        result.steps++;
+        result.max_step_seconds = std::max(
+            result.max_step_seconds,
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count());
+        QI_TRACE(Mc, Debug, "Beam level %d: kept %d of %d children, best qi <= %d\n",
+                 level[0].getNumBlocks(), width, static_cast<int>(candidates.size()), candidates[0].score.upper);
+        if (result.failed) break;
+    }
+    
+    result.counters = QiCounters::local() - start_counters;
+    result.final_blocks = level[0].getNumBlocks();
+    for (const Partition& partition : level) {
+        if (partition.getQiNumber() == -1) result.final_undetermined = true;
+    }
+    
+    // like a single chain, P* itself is only judged when no merge follows it
+    if (result.steps == 0 && !result.final_undetermined) {
+        result.failed = level[0].getQiNumber() < required_qi;
+    }
+    return result;
+}
+
+std::vector<StepTally> ChainRunner::runChains(int num_chains, int num_threads, uint64_t base_seed,
+                                              std::vector<ChainResult>& results) const {
+    ThreadPool pool(num_threads);
+    results.assign(num_chains, ChainResult());
+
+    // one tally table per worker, merged once every chain is done
+    std::vector<std::vector<StepTally>> worker_tallies(
+        pool.getNumThreads(), std::vector<StepTally>(graph_.num_vertices + 1));
+
+    pool.parallelFor(num_chains, [&](int chain, int worker) {
+        uint64_t seed = Xoshiro256::streamSeed(base_seed, static_cast<uint64_t>(chain));
+        Xoshiro256 rng(seed);
+        results[chain] = runChain(rng, worker_tallies[worker]);
+        results[chain].seed = seed;
+    });
+
+    std::vector<StepTally> tallies(graph_.num_vertices + 1);
+    for (const std::vector<StepTally>& worker : worker_tallies) {
+        for (int size = 0; size <= graph_.num_vertices; size++) {
+            tallies[size].pass += worker[size].pass;
+            tallies[size].fail += worker[size].fail;
+            tallies[size].undetermined += worker[size].undetermined;
+        }
+    }
+    return tallies;
+}
@@ -0,0 +1,108 @@
+#include "../include/Dsatur.h"
+#include "../include/QiCounters.h"
+
+template <int Words>
+Dsatur<Words>::Dsatur(const Set* adjacency, int block_count)
+    : adjacency_(adjacency), block_count_(block_count), num_colors_(0), heap_size_(0) {}
+
+template <int Words>
+int Dsatur<Words>::color() {
+    QiCounters::local().dsatur_calls++;
+    num_colors_ = 0;
+    heap_size_ = block_count_;
+    for (int b = 0; b < block_count_; b++) {
+        color_[b] = -1;
+        neighbour_colors_[b] = Set::none();
+        saturation_[b] = 0;
+        degree_[b] = adjacency_[b].count();
+        heap_[b] = b;
+        heap_pos_[b] = b;
+    }
+    for (int pos = heap_size_ / 2 - 1; pos >= 0; pos--) {
+        siftDown(pos);
+    }
+
+    Set all_colors = Set::firstN(block_count_);
+    while (heap_size_ > 0) {
+        int block = popMax();
+
+        // smallest color no neighbour uses
+        int c = all_colors.without(neighbour_colors_[block]).lowest();
+        color_[block] = c;
+        if (c + 1 > num_colors_) num_colors_ = c + 1;
+
+        Set neighbours = adjacency_[block];
+        for (int u = neighbours.popLowest(); u >= 0; u = neighbours.popLowest()) {
+            if (color_[u] >= 0) continue;
+            degree_[u]--;
+            if (!neighbour_colors_[u].test(c)) {
+                // saturation dominates the key, so the block only moves up
+                neighbour_colors_[u].set(c);
+                saturation_[u]++;
+                siftUp(heap_pos_[u]);
+            } else {
+                siftDown(heap_pos_[u]);
+            }
+        }
+    }
+    return num_colors_;
+}
+
+template <int Words>
+bool Dsatur<Words>::higherPriority(int block1, int block2) const {
+    if (saturation_[block1] != saturation_[block2]) {
+        return saturation_[block1] > saturation_[block2];
+    }
+    if (degree_[block1] != degree_[block2]) {
+        return degree_[block1] > degree_[block2];
+    }
+    return block1 < block2;
+}
+
+template <int Words>
+void Dsatur<Words>::siftUp(int pos) {
+    int block = heap_[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!higherPriority(block, heap_[parent])) break;
+        heap_[pos] = heap_[parent];
+        heap_pos_[heap_[pos]] = pos;
+        pos = parent;
+    }
+    heap_[pos] = block;
+    heap_pos_[block] = pos;
+}
+
+template <int Words>
+void Dsatur<Words>::siftDown(int pos) {
+    int block = heap_[pos];
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= heap_size_) break;
+        if (child + 1 < heap_size_ && higherPriority(heap_[child + 1], heap_[child])) {
+            child++;
+        }
+        if (!higherPriority(heap_[child], block)) break;
+        heap_[pos] = heap_[child];
+        heap_pos_[heap_[pos]] = pos;
+        pos = child;
+    }
+    heap_[pos] = block;
+    heap_pos_[block] = pos;
+}
+
+template <int Words>
+int Dsatur<Words>::popMax() {
+    int top = heap_[0];
+    heap_size_--;
+    if (heap_size_ > 0) {
+        heap_[0] = heap_[heap_size_];
+        heap_pos_[heap_[0]] = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+template class Dsatur<1>;
+template class Dsatur<2>;
+template class Dsatur<4>;
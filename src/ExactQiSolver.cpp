@@ -0,0 +1,170 @@
+#include "../include/ExactQiSolver.h"
+#include "../include/QiCounters.h"
+#include "../include/Trace.h"
+#include <string>
+#include <vector>
+
+template <int Words>
+ExactQiSolver<Words>::ExactQiSolver(const Set* adjacency, int block_count)
+    : adjacency_(adjacency), block_count_(block_count), min_required_qi_(0), max_qi_(0), cover_size_(0),
+      nodes_(0), sets_(0), frames_(nullptr), depth_(0) {}
+
+// frames for a search over block_count blocks; each thread keeps its own, grown as needed
+template <int Words>
+typename ExactQiSolver<Words>::Frame* ExactQiSolver<Words>::arena(int block_count) {
+    static thread_local std::vector<Frame> frames;
+    if (static_cast<int>(frames.size()) < block_count) frames.resize(block_count);
+    return frames.data();
+}
+
+template <int Words>
+int ExactQiSolver<Words>::solve() {
+    // qi never exceeds k - 1, so this threshold never triggers early stopping
+    return solve(block_count_);
+}
+
+template <int Words>
+int ExactQiSolver<Words>::solve(int min_required_qi) {
+    min_required_qi_ = min_required_qi;
+    max_qi_ = 0;
+    cover_size_ = 0;
+    // one set per block is the qi = 0 cover until something better is found
+    for (int b = 0; b < block_count_; b++) best_color_[b] = b;
+    if (block_count_ <= 1) return 0; // single block is q-complete
+
+    nodes_ = 0;
+    sets_ = 0;
+    frames_ = arena(block_count_);
+    depth_ = 0;
+    Set all = Set::firstN(block_count_);
+    Set chosen;
+    Set candidates;
+    if (startSet(all, 0, chosen, candidates)) growSet(all, chosen, candidates, Set::none(), 0);
+    search();
+
+    QiCounters& counters = QiCounters::local();
+    counters.search_nodes += nodes_;
+    counters.independent_sets += sets_;
+    return max_qi_;
+}
+
+// a new level of the cover: records a complete cover, or starts the set that must hold
+// the lowest uncovered block (false when there is nothing left to search)
+template <int Words>
+bool ExactQiSolver<Words>::startSet(const Set& remaining, int current_qi, Set& chosen, Set& candidates) {
+    // Early stopping: if we've already found a sufficient qi, stop searching
+    if (max_qi_ >= min_required_qi_) return false;
+    nodes_++;
+
+    if (remaining.empty()) {
+        if (current_qi > max_qi_) {
+            max_qi_ = current_qi;
+            for (int color = 0; color < cover_size_; color++) {
+                Set members = cover_[color];
+                for (int b = members.popLowest(); b >= 0; b = members.popLowest()) best_color_[b] = color;
+            }
+        }
+        return false;
+    }
+
+    // even one set holding every remaining block only adds (count - 1)
+    if (current_qi + remaining.count() - 1 <= max_qi_) return false;
+
+    // the lowest uncovered block must lie in some set; extending that set to a maximal
+    // independent set of the remaining blocks never increases the number of sets
+    int start_block = remaining.lowest();
+    chosen = Set::none();
+    chosen.set(start_block);
+    candidates = remaining.without(adjacency_[start_block]);
+    candidates.reset(start_block);
+    return true;
+}
+
+// Bron-Kerbosch with pivoting, run on the complement of the remaining quotient: a set
+// with candidates left becomes a frame holding its branch blocks, a maximal one joins
+// the cover and the next level starts in its place
+template <int Words>
+void ExactQiSolver<Words>::growSet(Set remaining, Set chosen, Set candidates, Set excluded, int current_qi) {
+    while (candidates.empty()) {
+        // maximal only when no excluded block could still join the set
+        if (!excluded.empty()) return;
+
+        int set_size = chosen.count();
+        sets_++;
+        if (Trace::enabled(TraceCategory::Search, TraceLevel::Detail)) {
+            std::string members_text;
+            Set members = chosen;
+            for (int b = members.popLowest(); b >= 0; b = members.popLowest()) {
+                members_text += std::to_string(b) + (members.empty() ? "" : ", ");
+            }
+            Trace::write("Found independent set (size %d, contributes %d): {%s}\n", set_size, set_size - 1,
+                         members_text.c_str());
+        }
+
+        cover_[cover_size_++] = chosen;
+        remaining = remaining.without(chosen);
+        current_qi += set_size - 1;
+        if (!startSet(remaining, current_qi, chosen, candidates)) return;
+        excluded = Set::none();
+    }
+
+    // pivot on the block compatible with the most candidates
+    Set pool = candidates | excluded;
+    int pivot = -1;
+    int best_compatible = -1;
+    for (int b = pool.popLowest(); b >= 0; b = pool.popLowest()) {
+        int compatible = candidates.without(adjacency_[b]).count();
+        if (compatible > best_compatible) {
+            best_compatible = compatible;
+            pivot = b;
+        }
+    }
+
+    // every maximal set contains the pivot or one of its neighbours; each frame holds a
+    // block no frame below it does, so k frames suffice
+    level_remaining_[cover_size_] = remaining;
+    level_qi_[cover_size_] = current_qi;
+    Frame& frame = frames_[depth_++];
+    frame.chosen = chosen;
+    frame.candidates = candidates;
+    frame.excluded = excluded;
+    frame.branch = candidates & adjacency_[pivot];
+    if (candidates.test(pivot)) frame.branch.set(pivot);
+    frame.cover_size = cover_size_;
+}
+
+template <int Words>
+void ExactQiSolver<Words>::search() {
+    while (depth_ > 0) {
+        // early stopping unwinds the whole stack
+        if (max_qi_ >= min_required_qi_) {
+            depth_ = 0;
+            return;
+        }
+
+        Frame& frame = frames_[depth_ - 1];
+        int b = frame.branch.popLowest();
+        if (b < 0) {
+            depth_--;
+            continue;
+        }
+
+        Set next_chosen = frame.chosen;
+        next_chosen.set(b);
+        Set next_candidates = frame.candidates.without(adjacency_[b]);
+        next_candidates.reset(b);
+        Set next_excluded = frame.excluded.without(adjacency_[b]);
+
+        // the sets through b are all in b's subtree, so b leaves the candidates for good
+        frame.candidates.reset(b);
+        frame.excluded.set(b);
+
+        cover_size_ = frame.cover_size;
+        growSet(level_remaining_[cover_size_], next_chosen, next_candidates, next_excluded,
+                level_qi_[cover_size_]);
+    }
+}
+
+template class ExactQiSolver<1>;
+template class ExactQiSolver<2>;
+template class ExactQiSolver<4>;
@@ -1,30 +1,135 @@
 #include "../include/Graph.h"
+#include "../include/Partition.h"
+#include <bit>
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <sstream>
+
+#ifdef _WIN32
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "binary graphs store little-endian words");
+
+namespace {
+
+const char BINARY_MAGIC[4] = {'Q', 'I', 'G', '1'};
+
+// read-only view of a whole file: mmap where available, otherwise one read
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    ~MappedFile() {
+#ifndef _WIN32
+        if (size_ > 0) munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    
+    bool open(const char* filename) {
+#ifdef _WIN32
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return true;
+#else
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                size_ = 0;
+                ::close(fd);
+                return false;
+            }
+            data_ = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+    
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+#ifdef _WIN32
+    std::vector<char> buffer_;
+#endif
+};
+
+void skipSpaces(const char*& cursor, const char* end, bool newlines) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' ||
+                            (newlines && *cursor == '\n'))) {
+        cursor++;
+    }
+}
+
+// optionally signed decimal; leaves cursor past the digits. Fails (cursor unmoved) when
+// there are no digits or the value does not fit an int.
+bool parseInt(const char*& cursor, const char* end, int& value) {
+    const char* start = cursor;
+    bool negative = cursor < end && *cursor == '-';
+    if (negative || (cursor < end && *cursor == '+')) cursor++;
+    long long parsed = 0;
+    long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    const char* digits = cursor;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        parsed = parsed * 10 + (*cursor++ - '0');
+        if (parsed > limit) {
+            cursor = start;
+            return false;
+        }
+    }
+    if (cursor == digits) {
+        cursor = start;
+        return false;
+    }
+    value = static_cast<int>(negative ? -parsed : parsed);
+    return true;
+}
+
+// start of the line after the one holding cursor (end when there is none)
+const char* nextLine(const char* cursor, const char* end) {
+    const void* newline = std::memchr(cursor, '\n', end - cursor);
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+} // namespace
 
 Graph::Graph() {
-    adjMatrix_ = nullptr;
     num_vertices = 0;
     critical_k = 0;
+    row_words_ = 0;
 }
 
 void Graph::init(int vertices) {
     this->num_vertices = vertices;
-    adjMatrix_ = new int[vertices * vertices];
+    row_words_ = (vertices + 63) / 64;
     
-    // initialize matrix to zero
-    for (int i = 0; i < vertices * vertices; ++i) {
-        adjMatrix_[i] = 0;
-    }
-}
-
-Graph::~Graph() {
-    if (adjMatrix_) {
-        delete[] adjMatrix_;
-        adjMatrix_ = nullptr;
-    }
+    // initialize matrix to zero, with empty neighbour lists until edges are added
+    adj_bits_.assign(static_cast<size_t>(vertices) * row_words_, 0);
+    neighbour_offsets_.assign(vertices + 1, 0);
+    neighbours_.clear();
 }
 
 void Graph::addEdge(int src, int dest) {
@@ -36,68 +141,177 @@ void Graph::addConnection(int src, int dest) {
     if (src < 0 || src >= num_vertices || dest < 0 || dest >= num_vertices) {
         return;
     }
-    adjMatrix_[src * num_vertices + dest] = 1;
-    adjMatrix_[dest * num_vertices + src] = 1; 
+    adj_bits_[src * row_words_ + (dest >> 6)] |= uint64_t(1) << (dest & 63);
+    adj_bits_[dest * row_words_ + (src >> 6)] |= uint64_t(1) << (src & 63);
 }
 
 bool Graph::hasEdge(int src, int dest) const {
-    return (adjMatrix_[src * num_vertices + dest] > 0);
+    return (adj_bits_[src * row_words_ + (dest >> 6)] >> (dest & 63)) & 1;
 }
 
 int Graph::getEdgeCount() const {
-    int edgeCount = 0;
-    for (int i = 0; i < num_vertices; ++i) {
-        for (int j = i + 1; j < num_vertices; ++j) {
-            if (hasEdge(i, j)) {
-                edgeCount++;
+    int endpoints = 0;
+    for (uint64_t word : adj_bits_) {
+        endpoints += std::popcount(word);
+    }
+    return endpoints / 2;
+}
+
+void Graph::buildAdjacencyLists() {
+    neighbour_offsets_.assign(num_vertices + 1, 0);
+    neighbours_.clear();
+    neighbours_.reserve(2 * getEdgeCount());
+    
+    // scan each bit row a word at a time, so lists come out sorted
+    for (int v = 0; v < num_vertices; v++) {
+        const uint64_t* row = getAdjacencyRow(v);
+        for (int w = 0; w < row_words_; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                neighbours_.push_back((w << 6) + std::countr_zero(bits));
             }
         }
+        neighbour_offsets_[v + 1] = static_cast<int>(neighbours_.size());
     }
-    return edgeCount;
 }
 
 bool Graph::loadFromFile(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Error: Could not open file " << filename << std::endl;
+    std::string error;
+    std::string warning;
+    bool loaded = loadFromFile(filename, error, warning);
+    if (!warning.empty()) std::cout << "Warning: " << warning << std::endl;
+    if (!loaded) std::cout << "Error: " << error << std::endl;
+    return loaded;
+}
+
+// dispatches on the first bytes: the binary magic, or else the text format
+bool Graph::loadFromFile(const char* filename, std::string& error, std::string& warning) {
+    error.clear();
+    warning.clear();
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = std::string("Could not open file ") + filename;
         return false;
     }
+    if (file.size() >= sizeof(BINARY_MAGIC) && std::memcmp(file.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+        return loadBinary(file.data(), file.size(), filename, error);
+    }
+    return loadText(file.data(), file.size(), error, warning);
+}
+
+// "n", then one "u v" edge per line up to the "k=<k'>" line
+bool Graph::loadText(const char* data, size_t size, std::string& error, std::string& warning) {
+    const char* cursor = data;
+    const char* end = data + size;
     
-    int n;
-    file >> n;
-    
-    if (n <= 0 || n > 99999) {
-        std::cout << "Error: Invalid number of vertices: " << n << std::endl;
-        file.close();
+    int n = 0;
+    skipSpaces(cursor, end, true);
+    if (!parseInt(cursor, end, n) || n <= 0) {
+        error = "Invalid number of vertices: " + std::to_string(n);
+        return false;
+    }
+    if (n > Partition::MAX_VERTICES) {
+        error = "graph has " + std::to_string(n) + " vertices; at most " + std::to_string(Partition::MAX_VERTICES) +
+                " are supported";
         return false;
     }
     
     // initialize graph with n vertices
     init(n);
     
-    // read edges until we hit the k= line
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
+    int invalid_edges = 0;
+    int first_src = 0, first_dest = 0;
+    for (const char* line = nextLine(cursor, end); line < end; line = nextLine(cursor, end)) {
+        cursor = line;
+        if (*cursor == '\n' || (*cursor == '\r' && cursor + 1 < end && cursor[1] == '\n')) continue;
         
-        // check if this is the k= line
-        if (line.substr(0, 2) == "k=") {
-            critical_k = std::stoi(line.substr(2));
+        // the k= line ends the edge list
+        if (end - cursor >= 2 && cursor[0] == 'k' && cursor[1] == '=') {
+            cursor += 2;
+            skipSpaces(cursor, end, false);
+            parseInt(cursor, end, critical_k);
             break;
         }
         
-        // parse edge
-        std::istringstream iss(line);
+        // lines that do not start with two integers are skipped
         int src, dest;
-        if (iss >> src >> dest) {
-            if (src >= 0 && src < n && dest >= 0 && dest < n && src != dest) {
-                addEdge(src, dest);
-            } else {
-                std::cout << "Warning: Invalid edge (" << src << ", " << dest << ") ignored" << std::endl;
+        skipSpaces(cursor, end, false);
+        if (!parseInt(cursor, end, src)) continue;
+        skipSpaces(cursor, end, false);
+        if (!parseInt(cursor, end, dest)) continue;
+        if (src >= 0 && src < n && dest >= 0 && dest < n && src != dest) {
+            addEdge(src, dest);
+        } else if (invalid_edges++ == 0) {
+            first_src = src;
+            first_dest = dest;
+        }
+    }
+    
+    // one warning per file rather than per line
+    if (invalid_edges > 0) {
+        warning = "Invalid edge (" + std::to_string(first_src) + ", " + std::to_string(first_dest) + ") ignored";
+        if (invalid_edges > 1) warning += " (and " + std::to_string(invalid_edges - 1) + " more)";
+    }
+    
+    buildAdjacencyLists();
+    return true;
+}
+
+// whether the bit rows form a simple undirected graph: no bits past n, no loops, and
+// every edge present in both endpoints' rows
+bool Graph::hasValidRows() const {
+    uint64_t padding = (num_vertices & 63) ? ~uint64_t(0) << (num_vertices & 63) : 0;
+    for (int v = 0; v < num_vertices; v++) {
+        const uint64_t* row = getAdjacencyRow(v);
+        if (row[row_words_ - 1] & padding) return false;
+        if (hasEdge(v, v)) return false;
+        for (int w = 0; w < row_words_; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                int u = w * 64 + std::countr_zero(bits);
+                if (!hasEdge(u, v)) return false;
             }
         }
     }
+    return true;
+}
+
+// header of four 32-bit little-endian words (magic, n, k', words per row), then the
+// bit rows exactly as adj_bits_ holds them
+bool Graph::loadBinary(const char* data, size_t size, const char* filename, std::string& error) {
+    uint32_t header[4];
+    if (size < sizeof(header)) {
+        error = std::string("Truncated binary graph ") + filename;
+        return false;
+    }
+    std::memcpy(header, data, sizeof(header));
+    int n = static_cast<int>(header[1]);
+    int row_words = static_cast<int>(header[3]);
+    if (n <= 0 || n > Partition::MAX_VERTICES || row_words != (n + 63) / 64 ||
+        size != sizeof(header) + static_cast<size_t>(n) * row_words * sizeof(uint64_t)) {
+        error = std::string("Malformed binary graph ") + filename;
+        return false;
+    }
     
-    file.close();
+    init(n);
+    critical_k = static_cast<int>(header[2]);
+    std::memcpy(adj_bits_.data(), data + sizeof(header), adj_bits_.size() * sizeof(uint64_t));
+    if (!hasValidRows()) {
+        error = std::string("Malformed binary graph ") + filename;
+        *this = Graph();
+        return false;
+    }
+    buildAdjacencyLists();
     return true;
-}
\ No newline at end of file
+}
+
+bool Graph::saveBinary(const char* filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    uint32_t header[4];
+    std::memcpy(header, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header[1] = static_cast<uint32_t>(num_vertices);
+    header[2] = static_cast<uint32_t>(critical_k);
+    header[3] = static_cast<uint32_t>(row_words_);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(adj_bits_.data()), adj_bits_.size() * sizeof(uint64_t));
+    return static_cast<bool>(file);
+}
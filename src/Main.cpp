@@ -1,27 +1,729 @@
 #include "../include/Graph.h"
 #include "../include/Partition.h"
 #include "../include/McOperations.h"
+#include "../include/MergePolicy.h"
+#include "../include/QiCache.h"
+#include "../include/QiCounters.h"
+#include "../include/BatchRunner.h"
+#include "../include/Certificate.h"
+#include "../include/ChainExplorer.h"
+#include "../include/ChainRunner.h"
+#include "../include/SearchBudget.h"
+#include "../include/ThreadPool.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <iomanip>
+#include <random>
 #include <string>
+#include <vector>
+
+// per-size PASS/FAIL/UNDETERMINED table (states column only for exhaustive runs)
+static void printTallies(const std::vector<StepTally>& tallies, const std::vector<long long>* states) {
+    std::cout << std::setw(10) << "Blocks";
+    if (states) std::cout << std::setw(12) << "STATES";
+    std::cout << std::setw(10) << "PASS" << std::setw(10) << "FAIL" << std::setw(14) << "UNDETERMINED" << std::endl;
+    for (int size = static_cast<int>(tallies.size()) - 1; size >= 0; size--) {
+        const StepTally& tally = tallies[size];
+        if (tally.pass + tally.fail + tally.undetermined == 0) continue;
+        std::cout << std::setw(10) << size;
+        if (states) std::cout << std::setw(12) << (*states)[size];
+        std::cout << std::setw(10) << tally.pass << std::setw(10) << tally.fail
+                  << std::setw(14) << tally.undetermined << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// same table as STEP_SIZE lines of the --output report
+static void writeTallies(std::ofstream& outfile, const std::vector<StepTally>& tallies,
+                         const std::vector<long long>* states) {
+    for (int size = static_cast<int>(tallies.size()) - 1; size >= 0; size--) {
+        const StepTally& tally = tallies[size];
+        if (tally.pass + tally.fail + tally.undetermined == 0) continue;
+        outfile << "STEP_SIZE: " << size;
+        if (states) outfile << " STATES=" << (*states)[size];
+        outfile << " PASS=" << tally.pass << " FAIL=" << tally.fail
+                << " UNDETERMINED=" << tally.undetermined << std::endl;
+    }
+}
+
+// where the qi work went, for the --output report (max_step_seconds < 0: no steps timed)
+static void writeCounters(std::ofstream& outfile, const QiCounters& counters, double total_seconds,
+                          double max_step_seconds) {
+    outfile << "SEARCH_NODES: " << counters.search_nodes << std::endl;
+    outfile << "INDEPENDENT_SETS: " << counters.independent_sets << std::endl;
+    outfile << "DSATUR_CALLS: " << counters.dsatur_calls << std::endl;
+    outfile << "EXACT_PATH: " << counters.exact_path << std::endl;
+    outfile << "FAST_PATH: " << counters.fast_path << std::endl;
+    outfile << "WITNESS_HITS: " << counters.witness_hits << std::endl;
+    outfile << "CACHE_LOOKUPS: " << counters.cache_lookups << std::endl;
+    outfile << "CACHE_HITS: " << counters.cache_hits << std::endl;
+#if QI_SAT_BACKEND
+    outfile << "SAT_PATH: " << counters.sat_path << std::endl;
+    outfile << "SAT_CONFLICTS: " << counters.sat_conflicts << std::endl;
+#endif
+    outfile << std::fixed << std::setprecision(6) << "TOTAL_SECONDS: " << total_seconds << std::endl;
+    if (max_step_seconds >= 0) outfile << "MAX_STEP_SECONDS: " << max_step_seconds << std::endl;
+    outfile << std::defaultfloat;
+    outfile << "PEAK_MEMORY_KB: " << peakMemoryKb() << std::endl;
+}
+
+// which path decided a step, from the counters it added
+static const char* stepPath(const QiCounters& delta) {
+    if (delta.witness_hits > 0) return "witness";
+    if (delta.cache_hits > 0) return "cache";
+    if (delta.sat_path > 0) return "sat";
+    if (delta.fast_path > 0) return "fast";
+    if (delta.exact_path > 0) return "exact";
+    return "trivial";
+}
+
+// write the qi cache back for the next run (no file given: nothing to do)
+static int saveQiCache(const std::string& cache_file, int return_code) {
+    if (cache_file.empty()) return return_code;
+    std::string error;
+    if (!QiCache::global().save(cache_file, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return return_code;
+    }
+    std::cout << QiCache::global().size() << " qi cache entries saved to " << cache_file << std::endl;
+    return return_code;
+}
+
+// "qi = 5" once the interval is closed, otherwise "qi in [3, 6]"
+static std::string formatQi(const QiBounds& bounds) {
+    if (bounds.isExact()) return "qi = " + std::to_string(bounds.lower);
+    return "qi in [" + std::to_string(bounds.lower) + ", " + std::to_string(bounds.upper) + "]";
+}
+
+// options besides --seed that a replay needs (the merge policy)
+static std::string replayOptions(MergePolicy policy, int beam_width) {
+    if (policy == MergePolicy::Uniform) return "";
+    std::string options = std::string(" --policy ") + mergePolicyName(policy);
+    if (policy == MergePolicy::Beam) options += " --beam-width " + std::to_string(beam_width);
+    return options;
+}
+
+// run many independent random chains in parallel and report per-size tallies
+static int runMultiChain(const Graph& graph, const std::string& graph_file, int num_chains,
+                         int num_threads, uint64_t base_seed, long long step_nodes, double step_seconds,
+                         MergePolicy policy, int beam_width, bool use_output_file, const std::string& output_file) {
+    auto start = std::chrono::steady_clock::now();
+    ChainRunner runner(graph);
+    runner.setStepBudget(step_nodes, step_seconds);
+    runner.setMergePolicy(policy, beam_width);
+    std::vector<ChainResult> results;
+    std::vector<StepTally> tallies = runner.runChains(num_chains, num_threads, base_seed, results);
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    int failed_chains = 0;
+    int undetermined_chains = 0;
+    int max_steps = 0;
+    int undecided_steps = 0;
+    QiCounters counters;
+    double max_step_seconds = 0;
+    for (const ChainResult& result : results) {
+        undecided_steps += result.undecided_steps;
+        counters += result.counters;
+        max_step_seconds = std::max(max_step_seconds, result.max_step_seconds);
+        if (result.failed) failed_chains++;
+        else if (result.final_undetermined) undetermined_chains++;
+        if (result.steps > max_steps) max_steps = result.steps;
+    }
+    
+    std::cout << "Ran " << num_chains << " chains on " << ThreadPool::resolveThreads(num_threads)
+              << " threads" << std::endl;
+    printTallies(tallies, nullptr);
+    if (undecided_steps > 0) {
+        std::cout << undecided_steps << " steps left undecided by their qi interval (tallied UNDETERMINED)" << std::endl;
+    }
+    
+    std::string result_status;
+    std::string result_detail;
+    int return_code = 0;
+    if (failed_chains > 0) {
+        std::cout << "VALIDATION FAILED: " << failed_chains << " of " << num_chains
+                  << " chains had qi below threshold" << std::endl;
+        for (const ChainResult& result : results) {
+            if (result.failed) {
+                std::cout << "Replay the first failing chain with --seed " << result.seed
+                          << replayOptions(policy, beam_width) << std::endl;
+                break;
+            }
+        }
+        result_status = "FAIL";
+        result_detail = std::to_string(failed_chains) + " of " + std::to_string(num_chains) +
+                        " chains had qi below required threshold";
+        return_code = 1;
+    } else if (undetermined_chains > 0) {
+        std::cout << "VALIDATION PARTIAL: " << undetermined_chains << " of " << num_chains
+                  << " chains ended with qi undetermined" << std::endl;
+        result_status = "PARTIAL";
+        result_detail = std::to_string(undetermined_chains) + " of " + std::to_string(num_chains) +
+                        " chains ended with final qi undetermined";
+    } else {
+        std::cout << "VALIDATION SUCCESSFUL: qi ≥ k - k' + 1 throughout all " << num_chains << " chains" << std::endl;
+        result_status = "PASS";
+        result_detail = "qi ≥ k - k' + 1 throughout all chains";
+    }
+    
+    if (use_output_file) {
+        std::ofstream outfile(output_file);
+        if (outfile.is_open()) {
+            outfile << "GRAPH: " << graph_file << std::endl;
+            outfile << "VERTICES: " << graph.num_vertices << std::endl;
+            outfile << "CRITICAL_K: " << graph.critical_k << std::endl;
+            outfile << "SEED: " << base_seed << std::endl;
+            outfile << "POLICY: " << mergePolicyName(policy) << std::endl;
+            if (policy == MergePolicy::Beam) outfile << "BEAM_WIDTH: " << beam_width << std::endl;
+            outfile << "CHAINS: " << num_chains << std::endl;
+            outfile << "STEPS: " << max_steps << std::endl;
+            outfile << "RESULT: " << result_status << std::endl;
+            outfile << "DETAIL: " << result_detail << std::endl;
+            outfile << "UNDECIDED_STEPS: " << undecided_steps << std::endl;
+            writeCounters(outfile, counters, total_seconds, max_step_seconds);
+            writeTallies(outfile, tallies, nullptr);
+            for (int chain = 0; chain < num_chains; chain++) {
+                if (results[chain].failed) {
+                    outfile << "FAILED_CHAIN: " << chain << " SEED=" << results[chain].seed << std::endl;
+                }
+            }
+            outfile.close();
+        } else {
+            std::cerr << "Error: Could not write to output file " << output_file << std::endl;
+        }
+    }
+    
+    return return_code;
+}
+
+// a beam from one seed: each level's checked partitions are tallied instead of printed
+static int runBeamChain(const Graph& graph, const std::string& graph_file, uint64_t seed, int beam_width,
+                        long long step_nodes, double step_seconds, bool use_output_file,
+                        const std::string& output_file) {
+    auto start = std::chrono::steady_clock::now();
+    ChainRunner runner(graph);
+    runner.setStepBudget(step_nodes, step_seconds);
+    runner.setMergePolicy(MergePolicy::Beam, beam_width);
+    Xoshiro256 rng(seed);
+    std::vector<StepTally> tallies(graph.num_vertices + 1);
+    ChainResult result = runner.runChain(rng, tallies);
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Followed a beam of up to " << beam_width << " partitions for " << result.steps
+              << " steps, down to size " << result.final_blocks << std::endl;
+    printTallies(tallies, nullptr);
+    if (result.undecided_steps > 0) {
+        std::cout << result.undecided_steps << " partitions left undecided by their qi interval (tallied UNDETERMINED)"
+                  << std::endl;
+    }
+    
+    std::string result_status;
+    std::string result_detail;
+    int return_code = 0;
+    if (result.failed) {
+        std::cout << "VALIDATION FAILED: qi below threshold at step " << result.steps << std::endl;
+        std::cout << "Replay this beam with --seed " << seed << replayOptions(MergePolicy::Beam, beam_width)
+                  << std::endl;
+        result_status = "FAIL";
+        result_detail = "qi below required threshold at step " + std::to_string(result.steps);
+        return_code = 1;
+    } else if (result.final_undetermined) {
+        std::cout << "VALIDATION PARTIAL: some final partitions of the beam have qi undetermined" << std::endl;
+        result_status = "PARTIAL";
+        result_detail = "Final qi undetermined - quotient graph too large";
+    } else {
+        std::cout << "VALIDATION SUCCESSFUL: qi ≥ k - k' + 1 throughout the beam" << std::endl;
+        result_status = "PASS";
+        result_detail = "qi ≥ k - k' + 1 throughout process";
+    }
+    
+    if (use_output_file) {
+        std::ofstream outfile(output_file);
+        if (outfile.is_open()) {
+            outfile << "GRAPH: " << graph_file << std::endl;
+            outfile << "VERTICES: " << graph.num_vertices << std::endl;
+            outfile << "CRITICAL_K: " << graph.critical_k << std::endl;
+            outfile << "SEED: " << seed << std::endl;
+            outfile << "POLICY: beam" << std::endl;
+            outfile << "BEAM_WIDTH: " << beam_width << std::endl;
+            outfile << "STEPS: " << result.steps << std::endl;
+            outfile << "RESULT: " << result_status << std::endl;
+            outfile << "DETAIL: " << result_detail << std::endl;
+            outfile << "UNDECIDED_STEPS: " << result.undecided_steps << std::endl;
+            writeCounters(outfile, result.counters, total_seconds, result.max_step_seconds);
+            writeTallies(outfile, tallies, nullptr);
+            outfile.close();
+        } else {
+            std::cerr << "Error: Could not write to output file " << output_file << std::endl;
+        }
+    }
+    
+    return return_code;
+}
+
+// explore every Mc chain, evaluating each distinct partition once
+static int runExhaustive(const Graph& graph, const std::string& graph_file, bool use_symmetry,
+                         const std::string& checkpoint_file, bool resume,
+                         bool use_output_file, const std::string& output_file) {
+    auto start = std::chrono::steady_clock::now();
+    QiCounters start_counters = QiCounters::local();
+    ChainExplorer explorer(graph, use_symmetry);
+    if (!checkpoint_file.empty()) {
+        std::string error;
+        if (resume && !explorer.resumeFrom(checkpoint_file, error)) {
+            std::cout << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (explorer.getResumedBlocks() > 0) {
+            std::cout << "Resuming from the level of " << explorer.getResumedBlocks() << " blocks in "
+                      << checkpoint_file << std::endl;
+        }
+        explorer.setCheckpoint(checkpoint_file);
+    }
+    ExplorationResult result = explorer.explore();
+    QiCounters counters = QiCounters::local() - start_counters;
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Explored " << result.total_states << " distinct partitions down to size "
+              << result.final_blocks << std::endl;
+    if (result.group_order > 1) {
+        std::cout << "Expanded " << result.total_orbits << " of them, one per orbit of "
+                  << result.group_order << " automorphisms";
+        int fixed = explorer.getAutomorphisms().getFixedVertices();
+        if (fixed > 0) std::cout << " (the subgroup fixing " << fixed << " vertices)";
+        std::cout << std::endl;
+    }
+    printTallies(result.tallies, &result.states);
+    
+    std::string result_status;
+    std::string result_detail;
+    int return_code = 0;
+    if (result.failed) {
+        std::cout << "VALIDATION FAILED: some reachable partition has qi below threshold" << std::endl;
+        result_status = "FAIL";
+        result_detail = "Some reachable partition has qi below required threshold";
+        return_code = 1;
+    } else if (result.final_undetermined) {
+        std::cout << "VALIDATION PARTIAL: some final partitions have qi undetermined" << std::endl;
+        result_status = "PARTIAL";
+        result_detail = "Some final partitions have qi undetermined";
+    } else {
+        std::cout << "VALIDATION SUCCESSFUL: qi ≥ k - k' + 1 on every Mc chain" << std::endl;
+        result_status = "PASS";
+        result_detail = "qi ≥ k - k' + 1 on every Mc chain";
+    }
+    
+    if (use_output_file) {
+        std::ofstream outfile(output_file);
+        if (outfile.is_open()) {
+            outfile << "GRAPH: " << graph_file << std::endl;
+            outfile << "VERTICES: " << graph.num_vertices << std::endl;
+            outfile << "CRITICAL_K: " << graph.critical_k << std::endl;
+            outfile << "STATES: " << result.total_states << std::endl;
+            outfile << "ORBITS: " << result.total_orbits << std::endl;
+            outfile << "AUTOMORPHISMS: " << result.group_order << std::endl;
+            outfile << "STEPS: " << (graph.num_vertices - result.final_blocks) << std::endl;
+            outfile << "RESULT: " << result_status << std::endl;
+            outfile << "DETAIL: " << result_detail << std::endl;
+            writeCounters(outfile, counters, total_seconds, -1.0);
+            writeTallies(outfile, result.tallies, &result.states);
+            outfile.close();
+        } else {
+            std::cerr << "Error: Could not write to output file " << output_file << std::endl;
+        }
+    }
+    
+    return return_code;
+}
+
+// a seed for runs without --seed; always printed or reported so the run can be replayed
+static uint64_t freshSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^
+           static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+// batch results in the requested format, then the summary; returns the exit code
+static int writeBatchResults(const std::string& output_file, const std::string& format,
+                             const std::vector<BatchEntry>& entries) {
+    std::ofstream outfile(output_file);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Could not write to output file " << output_file << std::endl;
+        return 1;
+    }
+    if (format == "csv") {
+        BatchRunner::writeCsv(outfile, entries);
+    } else {
+        BatchRunner::writeJsonLines(outfile, entries);
+    }
+    outfile.close();
+    
+    // summary in the same categories as test_runner.py
+    const char* categories[] = {"PASS", "PARTIAL", "FAIL", "TIMEOUT", "SKIPPED", "ERROR"};
+    int failures = 0;
+    for (const char* category : categories) {
+        int count = 0;
+        for (const BatchEntry& entry : entries) {
+            if (entry.result == category) count++;
+        }
+        std::cout << std::left << std::setw(9) << (std::string(category) + ":") << std::right
+                  << count << std::endl;
+        if (std::string(category) == "FAIL" || std::string(category) == "ERROR") failures += count;
+    }
+    std::cout << "Results written to " << output_file << std::endl;
+    return failures > 0 ? 1 : 0;
+}
+
+// validate every graph of a directory or manifest (or one shard of them) and write one
+// results file
+static int runBatch(const std::string& batch_path, const std::string& output_file,
+                    const std::string& format, int num_threads, uint64_t base_seed,
+                    double time_budget_seconds, long long step_nodes, double step_seconds,
+                    MergePolicy policy, int beam_width, int shard_index, int num_shards,
+                    const std::string& checkpoint_file, bool resume) {
+    if (format != "jsonl" && format != "csv") {
+        std::cout << "Error: unknown batch format " << format << " (expected jsonl or csv)" << std::endl;
+        return 1;
+    }
+    
+    std::vector<std::string> files;
+    std::string error;
+    if (!BatchRunner::collectGraphFiles(batch_path, files, error)) {
+        std::cout << "Error: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "Validating " << files.size() << " graphs";
+    if (num_shards > 1) std::cout << " (shard " << shard_index << "/" << num_shards << ")";
+    std::cout << " on " << ThreadPool::resolveThreads(num_threads) << " threads (seed " << base_seed << ")"
+              << std::endl;
+    
+    BatchRunner runner(num_threads, base_seed, time_budget_seconds);
+    runner.setStepBudget(step_nodes, step_seconds);
+    runner.setMergePolicy(policy, beam_width);
+    runner.setShard(shard_index, num_shards);
+    if (!checkpoint_file.empty()) runner.setCheckpoint(checkpoint_file, resume);
+    std::vector<BatchEntry> entries;
+    if (!runner.run(files, entries, error)) {
+        std::cout << "Error: " << error << std::endl;
+        return 1;
+    }
+    return writeBatchResults(output_file, format, entries);
+}
+
+// join the JSON Lines results of several shards into one results file, ordered by graph
+static int runMerge(const std::string& output_file, const std::string& format,
+                    const std::vector<std::string>& shard_files) {
+    if (format != "jsonl" && format != "csv") {
+        std::cout << "Error: unknown batch format " << format << " (expected jsonl or csv)" << std::endl;
+        return 1;
+    }
+    
+    std::vector<BatchEntry> entries;
+    for (const std::string& shard_file : shard_files) {
+        std::vector<BatchEntry> shard;
+        std::string error;
+        if (!BatchRunner::readJsonLines(shard_file, shard, error)) {
+            std::cout << "Error: " << error << std::endl;
+            return 1;
+        }
+        entries.insert(entries.end(), shard.begin(), shard.end());
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const BatchEntry& a, const BatchEntry& b) { return a.graph < b.graph; });
+    for (size_t i = 1; i < entries.size(); i++) {
+        if (entries[i].graph == entries[i - 1].graph) {
+            std::cout << "Error: " << entries[i].graph << " appears in more than one results file" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Merged " << entries.size() << " graphs from " << shard_files.size() << " results files"
+              << std::endl;
+    return writeBatchResults(output_file, format, entries);
+}
+
+// check a --certificates file against its graph without searching
+static int runVerify(const std::string& graph_file, const std::string& certificate_file) {
+    Graph graph;
+    if (!graph.loadFromFile(graph_file.c_str())) {
+        std::cout << "Failed to load graph from " << graph_file << std::endl;
+        return 1;
+    }
+    
+    CertificateVerifier verifier(graph);
+    std::string error;
+    if (!verifier.verify(certificate_file, error)) {
+        std::cout << "CERTIFICATE INVALID: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "CERTIFICATE VALID: " << verifier.getStepsVerified() << " steps certified";
+    if (verifier.getLastStep() >= 0) std::cout << " (last step " << verifier.getLastStep() << ")";
+    std::cout << std::endl;
+    if (!verifier.getMissingSteps().empty()) {
+        std::cout << "WARNING: " << verifier.getMissingSteps().size() << " steps have no certificate: "
+                  << verifier.formatMissingSteps() << std::endl;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    if (argc < 2 || argc > 4) {
-        std::cout << "Usage: " << argv[0] << " <graph_file> [--output <output_file>]" << std::endl;
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> [--output <output_file>]"
+                  << " [--seed <seed>] [--chains <count> [--threads <count>] | --exhaustive [--no-symmetry]]"
+                  << " [--step-nodes <count>] [--step-time <seconds>] [--certificates <file>]"
+                  << " [--step-csv <file>] [--trace <category:level,...>] [--trace-file <file>]"
+                  << " [--qi-cache <file> | --no-qi-cache] [--search-threads <count>]"
+                  << " [--policy uniform|greedy|anneal|beam [--beam-width <count>]]"
+                  << " [--checkpoint <file> [--resume]]" << std::endl;
+        std::cout << "       " << argv[0] << " --batch <graph_dir|manifest> --output <results_file>"
+                  << " [--format jsonl|csv] [--threads <count>] [--seed <seed>] [--time-budget <seconds>]"
+                  << " [--step-nodes <count>] [--step-time <seconds>] [--qi-cache <file> | --no-qi-cache]"
+                  << " [--policy uniform|greedy|anneal|beam [--beam-width <count>]]"
+                  << " [--shard <i>/<n>] [--checkpoint <file> [--resume]]" << std::endl;
+        std::cout << "       " << argv[0] << " --merge <results_file> <shard_results>... [--format jsonl|csv]"
+                  << std::endl;
+        std::cout << "       " << argv[0] << " --verify <graph_file> <certificate_file>" << std::endl;
+        std::cout << "       " << argv[0] << " --convert <graph_file> <binary_graph_file>" << std::endl;
         return 1;
     }
     
+    // text to binary graph (or back through the same loader): one file per call
+    if (std::string(argv[1]) == "--convert") {
+        Graph graph;
+        if (argc < 4) {
+            std::cout << "Error: --convert needs <graph_file> <binary_graph_file>" << std::endl;
+            return 1;
+        }
+        if (!graph.loadFromFile(argv[2])) return 1;
+        if (!graph.saveBinary(argv[3])) {
+            std::cerr << "Error: Could not write to binary graph file " << argv[3] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (std::string(argv[1]) == "--verify") {
+        if (argc < 4) {
+            std::cout << "Error: --verify needs <graph_file> <certificate_file>" << std::endl;
+            return 1;
+        }
+        return runVerify(argv[2], argv[3]);
+    }
+    
+    if (std::string(argv[1]) == "--merge") {
+        std::string merge_format = "jsonl";
+        std::vector<std::string> shard_files;
+        for (int i = 3; i < argc; i++) {
+            if (std::string(argv[i]) == "--format" && i + 1 < argc) {
+                merge_format = argv[++i];
+            } else {
+                shard_files.push_back(argv[i]);
+            }
+        }
+        if (argc < 3 || shard_files.empty()) {
+            std::cout << "Error: --merge needs <results_file> and at least one shard results file" << std::endl;
+            return 1;
+        }
+        return runMerge(argv[2], merge_format, shard_files);
+    }
+    
+    // --batch takes the place of the graph file
     std::string graph_file = argv[1];
+    std::string batch_path = "";
+    int first_option = 2;
+    if (graph_file == "--batch" && argc > 2) {
+        batch_path = argv[2];
+        first_option = 3;
+    }
     std::string output_file = "";
     bool use_output_file = false;
+    int num_chains = 0;   // 0 = single chain with step-by-step output
+    int num_threads = 0;  // 0 = every hardware thread
+    bool exhaustive = false;
+    bool use_seed = false;
+    uint64_t seed = 0;
+    std::string batch_format = "jsonl";
+    double time_budget_seconds = 60.0;  // per graph in batch mode, as test_runner.py allowed
+    long long step_nodes = 0;           // per-step qi search limits, 0 = none
+    double step_seconds = 0;
+    std::string certificate_file = "";  // single-chain PASS step certificates
+    std::string trace_spec = "";        // QI_TRACE from the environment unless --trace is given
+    std::string trace_file = "";
+    std::string step_csv_file = "";     // single-chain per-step timings and counters
+    std::string qi_cache_file = "";     // qi cache loaded at start and saved at the end
+    bool use_qi_cache = true;
+    bool use_symmetry = true;           // exhaustive runs: one partition per automorphism orbit
+    int search_threads = 1;             // threads per qi search (single-chain and exhaustive runs)
+    bool set_search_threads = false;
+    std::string checkpoint_file = "";   // batch: finished graphs; exhaustive: the last level
+    bool resume = false;
+    int shard_index = 0;                // batch graphs with index shard_index mod num_shards
+    int num_shards = 1;
+    bool valid_shard = true;
+    MergePolicy policy = MergePolicy::Uniform;  // how chains pick their merges
+    std::string policy_name = "uniform";
+    int beam_width = 8;
+    if (const char* env_trace = std::getenv("QI_TRACE")) trace_spec = env_trace;
     
     // Parse command line arguments
-    for (int i = 2; i < argc; i++) {
+    for (int i = first_option; i < argc; i++) {
         if (std::string(argv[i]) == "--output" && i + 1 < argc) {
             output_file = argv[i + 1];
             use_output_file = true;
             i++; // Skip the next argument
+        } else if (std::string(argv[i]) == "--chains" && i + 1 < argc) {
+            num_chains = std::atoi(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--threads" && i + 1 < argc) {
+            num_threads = std::atoi(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+            use_seed = true;
+            i++;
+        } else if (std::string(argv[i]) == "--exhaustive") {
+            exhaustive = true;
+        } else if (std::string(argv[i]) == "--format" && i + 1 < argc) {
+            batch_format = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--time-budget" && i + 1 < argc) {
+            time_budget_seconds = std::atof(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--step-nodes" && i + 1 < argc) {
+            step_nodes = std::atoll(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--step-time" && i + 1 < argc) {
+            step_seconds = std::atof(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--certificates" && i + 1 < argc) {
+            certificate_file = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            trace_spec = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--trace-file" && i + 1 < argc) {
+            trace_file = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--step-csv" && i + 1 < argc) {
+            step_csv_file = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--qi-cache" && i + 1 < argc) {
+            qi_cache_file = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--no-qi-cache") {
+            use_qi_cache = false;
+        } else if (std::string(argv[i]) == "--no-symmetry") {
+            use_symmetry = false;
+        } else if (std::string(argv[i]) == "--search-threads" && i + 1 < argc) {
+            search_threads = std::atoi(argv[i + 1]);
+            set_search_threads = true;
+            i++;
+        } else if (std::string(argv[i]) == "--checkpoint" && i + 1 < argc) {
+            checkpoint_file = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--policy" && i + 1 < argc) {
+            policy_name = argv[i + 1];
+            i++;
+        } else if (std::string(argv[i]) == "--beam-width" && i + 1 < argc) {
+            beam_width = std::atoi(argv[i + 1]);
+            i++;
+        } else if (std::string(argv[i]) == "--resume") {
+            resume = true;
+        } else if (std::string(argv[i]) == "--shard" && i + 1 < argc) {
+            char slash = 0;
+            valid_shard = std::sscanf(argv[i + 1], "%d%c%d", &shard_index, &slash, &num_shards) == 3 &&
+                          slash == '/' && num_shards > 0 && shard_index >= 0 && shard_index < num_shards;
+            i++;
+        }
+    }
+    
+    std::string trace_error;
+    if ((!trace_spec.empty() && !Trace::configure(trace_spec, trace_error)) ||
+        (!trace_file.empty() && !Trace::setSink(trace_file, trace_error))) {
+        std::cout << "Error: " << trace_error << std::endl;
+        return 1;
+    }
+    
+    if (!certificate_file.empty() && (!batch_path.empty() || exhaustive || num_chains > 0)) {
+        std::cout << "Error: --certificates only applies to single-chain runs" << std::endl;
+        return 1;
+    }
+    if (!step_csv_file.empty() && (!batch_path.empty() || exhaustive || num_chains > 0)) {
+        std::cout << "Error: --step-csv only applies to single-chain runs" << std::endl;
+        return 1;
+    }
+    
+    if (!parseMergePolicy(policy_name, policy)) {
+        std::cout << "Error: unknown merge policy " << policy_name << " (expected uniform, greedy, anneal or beam)"
+                  << std::endl;
+        return 1;
+    }
+    if (beam_width < 1) {
+        std::cout << "Error: --beam-width must be at least 1" << std::endl;
+        return 1;
+    }
+    if (policy != MergePolicy::Uniform && exhaustive) {
+        std::cout << "Error: --policy does not apply to --exhaustive runs, which follow every chain" << std::endl;
+        return 1;
+    }
+    if (policy == MergePolicy::Beam && (!certificate_file.empty() || !step_csv_file.empty())) {
+        std::cout << "Error: --certificates and --step-csv follow a single chain, not a beam" << std::endl;
+        return 1;
+    }
+    
+    if (!valid_shard) {
+        std::cout << "Error: --shard takes <i>/<n> with 0 <= i < n" << std::endl;
+        return 1;
+    }
+    if (num_shards > 1 && batch_path.empty()) {
+        std::cout << "Error: --shard only applies to --batch runs" << std::endl;
+        return 1;
+    }
+    if (!checkpoint_file.empty() && batch_path.empty() && !exhaustive) {
+        std::cout << "Error: --checkpoint only applies to --batch and --exhaustive runs" << std::endl;
+        return 1;
+    }
+    if (resume && checkpoint_file.empty()) {
+        std::cout << "Error: --resume needs --checkpoint <file>" << std::endl;
+        return 1;
+    }
+    
+    // chains and batch graphs already keep every thread busy
+    if (set_search_threads && (!batch_path.empty() || num_chains > 0)) {
+        std::cout << "Error: --search-threads only applies to single-chain and exhaustive runs" << std::endl;
+        return 1;
+    }
+    Partition::setSearchThreads(search_threads);
+    
+    if (!qi_cache_file.empty() && !use_qi_cache) {
+        std::cout << "Error: --qi-cache and --no-qi-cache exclude each other" << std::endl;
+        return 1;
+    }
+    QiCache::global().setEnabled(use_qi_cache);
+    std::string cache_error;
+    size_t dropped_entries = 0;
+    if (!qi_cache_file.empty() && !QiCache::global().load(qi_cache_file, cache_error, dropped_entries)) {
+        std::cout << "Error: " << cache_error << std::endl;
+        return 1;
+    }
+    if (dropped_entries > 0) {
+        std::cout << "Warning: " << dropped_entries << " invalid qi cache entries in " << qi_cache_file
+                  << " ignored" << std::endl;
+    }
+    
+    if (!batch_path.empty()) {
+        if (!use_output_file) {
+            std::cout << "Error: --batch needs --output <results_file>" << std::endl;
+            return 1;
         }
+        return saveQiCache(qi_cache_file,
+                           runBatch(batch_path, output_file, batch_format, num_threads,
+                                    use_seed ? seed : freshSeed(), time_budget_seconds, step_nodes, step_seconds,
+                                    policy, beam_width, shard_index, num_shards, checkpoint_file, resume));
     }
     
     // Load graph from file
@@ -33,6 +735,33 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Loaded graph with " << graph.num_vertices << " vertices, k'=" << graph.critical_k << std::endl;
     
+    if (exhaustive) {
+        return saveQiCache(qi_cache_file,
+                           runExhaustive(graph, graph_file, use_symmetry, checkpoint_file, resume,
+                                         use_output_file, output_file));
+    }
+    
+    // Without --seed pick a fresh one; it is printed and reported so the run can be replayed
+    if (!use_seed) {
+        seed = freshSeed();
+    }
+    std::cout << "Seed: " << seed << std::endl;
+    
+    if (num_chains > 0) {
+        return saveQiCache(qi_cache_file,
+                           runMultiChain(graph, graph_file, num_chains, num_threads, seed, step_nodes,
+                                         step_seconds, policy, beam_width, use_output_file, output_file));
+    }
+    
+    if (policy == MergePolicy::Beam) {
+        return saveQiCache(qi_cache_file,
+                           runBeamChain(graph, graph_file, seed, beam_width, step_nodes, step_seconds,
+                                        use_output_file, output_file));
+    }
+    
+    Xoshiro256 rng(seed);
+    MergeSelector selector(graph, policy);
+    
     // Create initial partition P* (each vertex in its own block)
     int initial_partition[Partition::MAX_VERTICES];
     for (int i = 0; i < graph.num_vertices; i++) {
@@ -41,73 +770,144 @@ int main(int argc, char* argv[]) {
     
     Partition current_partition(initial_partition, graph.num_vertices);
     
+    CertificateWriter certificates;
+    bool write_certificates = !certificate_file.empty();
+    if (write_certificates && !certificates.open(certificate_file, graph_file, graph, seed)) {
+        std::cerr << "Error: Could not write to certificate file " << certificate_file << std::endl;
+        return 1;
+    }
+    
+    std::ofstream step_csv;
+    if (!step_csv_file.empty()) {
+        step_csv.open(step_csv_file);
+        if (!step_csv.is_open()) {
+            std::cerr << "Error: Could not write to step CSV file " << step_csv_file << std::endl;
+            return 1;
+        }
+        step_csv << "step,blocks,required_qi,qi_lo,qi_hi,result,path,seconds,search_nodes,independent_sets,dsatur_calls\n";
+    }
+    auto run_start = std::chrono::steady_clock::now();
+    QiCounters run_counters = QiCounters::local();
+    double max_step_seconds = 0;
+    
     std::cout << "Starting qi validation:" << std::endl;
     std::cout << "Target partition size: " << graph.critical_k << std::endl;
     std::cout << std::endl;
     
     // Calculate and output initial qi number (with early stopping)
     int initial_required_qi = current_partition.getNumBlocks() - graph.critical_k + 1;
-    current_partition.calculateQiNumber(graph, initial_required_qi);
+    SearchBudget initial_budget = SearchBudget::fromNow(step_nodes, step_seconds);
+    current_partition.calculateQiNumber(graph, initial_required_qi, initial_budget);
     
     if (current_partition.getQiNumber() == -1) {
         std::cout << "Initial partition (size " << current_partition.getNumBlocks() 
-                  << "): qi = UNDETERMINED (quotient graph too large for exact computation)" << std::endl;
-        std::cout << "Continuing with Mc operations - will switch to exact computation when quotient size ≤ 15..." << std::endl;
+                  << "): " << formatQi(current_partition.getQiBounds())
+                  << " UNDETERMINED (quotient graph too large for exact computation)" << std::endl;
+        std::cout << "Continuing with Mc operations - will switch to exact computation when quotient size ≤ "
+                  << Partition::EXACT_QI_MAX_BLOCKS << "..." << std::endl;
     } else {
         std::cout << "Initial partition (size " << current_partition.getNumBlocks() 
-                  << "): qi = " << current_partition.getQiNumber() << std::endl;
+                  << "): " << formatQi(current_partition.getQiBounds()) << std::endl;
+        if (write_certificates && current_partition.getQiBounds().certifies(initial_required_qi)) {
+            certificates.writeStep(0, current_partition);
+        }
     }
     
     int step = 1;
+    int failed_step = 0;
+    
+    // steps left undecided, with the interval proven by then
+    std::vector<std::string> undecided_steps;
     
     // Perform Mc operations until we reach target size
     while (current_partition.getNumBlocks() > graph.critical_k) {
-        Partition next_partition = McOperations::performRandomMcOperation(current_partition, graph);
-        
-        // Check if we made progress
-        if (next_partition.getNumBlocks() == current_partition.getNumBlocks()) {
+        // merge in place; the chain never needs the previous partition again
+        auto step_start = std::chrono::steady_clock::now();
+        QiCounters step_counters = QiCounters::local();
+        int block1, block2;
+        if (!selector.choose(current_partition, rng, block1, block2)) {
             std::cout << "No more Mc operations available. Stopping at size " 
                       << current_partition.getNumBlocks() << std::endl;
             break;
         }
+        current_partition.mergeBlocks(block1, block2);
         
         // Use early stopping - only need qi >= threshold
-        int required_qi = next_partition.getNumBlocks() - graph.critical_k + 1;
-        next_partition.calculateQiNumber(graph, required_qi);
+        int required_qi = current_partition.getNumBlocks() - graph.critical_k + 1;
+        SearchBudget budget = SearchBudget::fromNow(step_nodes, step_seconds);
+        current_partition.calculateQiNumber(graph, required_qi, budget);
+        const QiBounds& bounds = current_partition.getQiBounds();
         
-        if (next_partition.getQiNumber() == -1) {
-            std::cout << "Step " << step << " (size " << next_partition.getNumBlocks() 
-                      << "): qi = UNDETERMINED (quotient graph still too large)" << std::endl;
+        double step_seconds_taken = std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count();
+        max_step_seconds = std::max(max_step_seconds, step_seconds_taken);
+        if (step_csv.is_open()) {
+            QiCounters delta = QiCounters::local() - step_counters;
+            const char* step_result = current_partition.getQiNumber() == -1 ? "UNDETERMINED"
+                                      : bounds.refutes(required_qi) ? "FAIL" : "PASS";
+            step_csv << step << ',' << current_partition.getNumBlocks() << ',' << required_qi << ','
+                     << bounds.lower << ',' << bounds.upper << ',' << step_result << ',' << stepPath(delta) << ','
+                     << std::fixed << std::setprecision(6) << step_seconds_taken << std::defaultfloat << ','
+                     << delta.search_nodes << ',' << delta.independent_sets << ',' << delta.dsatur_calls << '\n';
+        }
+        
+        if (current_partition.getQiNumber() == -1) {
+            // the threshold is still inside the proven interval
+            std::cout << "Step " << step << " (size " << current_partition.getNumBlocks() 
+                      << "): " << formatQi(bounds) << " (qi >= " << required_qi << " required) UNDETERMINED"
+                      << (bounds.exhausted ? ": search budget exhausted" : "") << std::endl;
             std::cout << "         Continuing with Mc operations..." << std::endl;
+            undecided_steps.push_back("step=" + std::to_string(step) +
+                                      " blocks=" + std::to_string(current_partition.getNumBlocks()) +
+                                      " QI_LO=" + std::to_string(bounds.lower) +
+                                      " QI_HI=" + std::to_string(bounds.upper) +
+                                      " REQUIRED=" + std::to_string(required_qi));
         } else {
-            std::cout << "Step " << step << " (size " << next_partition.getNumBlocks() 
-                      << "): qi = " << next_partition.getQiNumber();
+            std::cout << "Step " << step << " (size " << current_partition.getNumBlocks() 
+                      << "): " << formatQi(bounds);
             
-            // Check if qi meets threshold (qi >= k - k' + 1)
+            // Check if qi meets threshold (qi >= k - k' + 1): decided by the interval alone
             std::cout << " (qi >= " << required_qi << " required)";
             
-            if (next_partition.getQiNumber() < required_qi) {
+            if (bounds.refutes(required_qi)) {
                 std::cout << " ERROR: qi below required threshold!" << std::endl;
-                return 1;
+                
+                // stop here, but still write the report (with its seed) for replay
+                failed_step = step;
+                step++;
+                break;
             } else {
                 std::cout << " PASS" << std::endl;
+                if (write_certificates) certificates.writeStep(step, current_partition);
             }
         }
         
-        current_partition = next_partition;
         step++;
     }
     
+    QiCounters counters = QiCounters::local() - run_counters;
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+    
     std::cout << std::endl;
     std::cout << "Final partition size: " << current_partition.getNumBlocks() << std::endl;
+    if (write_certificates) {
+        std::cout << certificates.getStepsWritten() << " step certificates written to " << certificate_file
+                  << " (check with --verify)" << std::endl;
+    }
     
     // Determine validation result
     std::string result_status;
     std::string result_detail;
     int return_code = 0;
     
-    if (current_partition.getQiNumber() == -1) {
-        std::cout << "Final qi number: UNDETERMINED (final quotient graph still too large)" << std::endl;
+    if (failed_step > 0) {
+        std::cout << "VALIDATION FAILED: qi below threshold at step " << failed_step << std::endl;
+        std::cout << "Replay this chain with --seed " << seed << replayOptions(policy, beam_width) << std::endl;
+        result_status = "FAIL";
+        result_detail = "qi below required threshold at step " + std::to_string(failed_step);
+        return_code = 1;
+    } else if (current_partition.getQiNumber() == -1) {
+        std::cout << "Final qi number: UNDETERMINED, " << formatQi(current_partition.getQiBounds())
+                  << " (final quotient graph still too large)" << std::endl;
         std::cout << "VALIDATION PARTIAL: Completed Mc operations but cannot verify final qi threshold" << std::endl;
         std::cout << "NOTE: For proof purposes, exact computation would be needed for final validation" << std::endl;
         result_status = "PARTIAL";
@@ -119,7 +919,7 @@ int main(int argc, char* argv[]) {
         int final_required_qi = current_partition.getNumBlocks() - graph.critical_k + 1;
         std::cout << "Required final qi: " << final_required_qi << std::endl;
         
-        if (current_partition.getQiNumber() >= final_required_qi) {
+        if (current_partition.getQiBounds().certifies(final_required_qi)) {
             std::cout << "VALIDATION SUCCESSFUL: qi ≥ k - k' + 1 throughout process" << std::endl;
             result_status = "PASS";
             result_detail = "qi ≥ k - k' + 1 throughout process";
@@ -139,14 +939,21 @@ int main(int argc, char* argv[]) {
             outfile << "GRAPH: " << graph_file << std::endl;
             outfile << "VERTICES: " << graph.num_vertices << std::endl;
             outfile << "CRITICAL_K: " << graph.critical_k << std::endl;
+            outfile << "SEED: " << seed << std::endl;
+            outfile << "POLICY: " << mergePolicyName(policy) << std::endl;
             outfile << "STEPS: " << (step - 1) << std::endl;
             outfile << "RESULT: " << result_status << std::endl;
             outfile << "DETAIL: " << result_detail << std::endl;
+            outfile << "UNDECIDED_STEPS: " << undecided_steps.size() << std::endl;
+            writeCounters(outfile, counters, total_seconds, max_step_seconds);
+            for (const std::string& undecided : undecided_steps) {
+                outfile << "STEP_BOUNDS: " << undecided << std::endl;
+            }
             outfile.close();
         } else {
             std::cerr << "Error: Could not write to output file " << output_file << std::endl;
         }
     }
     
-    return return_code;
+    return saveQiCache(qi_cache_file, return_code);
 }
\ No newline at end of file
@@ -1,35 +1,32 @@
 #include "../include/McOperations.h"
-#include <cstdlib>
-#include <ctime>
-#include <cstdio>
+#include "../include/Trace.h"
+
+namespace {
+
+// neighbours of block1 with a larger label, so each quotient edge is seen once
+QuotientGraph::Row laterNeighbours(const QuotientGraph& quotient, int block1) {
+    return quotient.getNeighbours(block1).without(QuotientGraph::Row::firstN(block1 + 1));
+}
+
+} // namespace
 
 int McOperations::findAllMcOperations(const Partition& partition, const Graph& graph, 
-                                      int* block1_array, int* block2_array) {
-    int count = 0;
-    int num_blocks = partition.getNumBlocks();
+                                      std::vector<int>& block1_array, std::vector<int>& block2_array) {
+    const QuotientGraph& quotient = partition.getQuotientGraph(graph);
+    block1_array.clear();
+    block2_array.clear();
     
-    // Get all used block labels
-    bool used_labels[Partition::MAX_VERTICES] = {false};
-    for (int v = 0; v < partition.getNumVertices(); v++) {
-        used_labels[partition.getLabel(v)] = true;
-    }
-    
-    // Find all pairs of blocks that are connected in quotient graph
-    for (int b1 = 0; b1 < Partition::MAX_VERTICES; b1++) {
-        if (!used_labels[b1]) continue;
-        
-        for (int b2 = b1 + 1; b2 < Partition::MAX_VERTICES; b2++) {
-            if (!used_labels[b2]) continue;
-            
-            if (partition.areBlocksConnectedInQuotient(graph, b1, b2)) {
-                block1_array[count] = b1;
-                block2_array[count] = b2;
-                count++;
-            }
+    // Walk the quotient rows: every edge b1 < b2 is one candidate merge
+    QuotientGraph::Row blocks = quotient.getBlocks();
+    for (int b1 = blocks.popLowest(); b1 >= 0; b1 = blocks.popLowest()) {
+        QuotientGraph::Row later = laterNeighbours(quotient, b1);
+        for (int b2 = later.popLowest(); b2 >= 0; b2 = later.popLowest()) {
+            block1_array.push_back(b1);
+            block2_array.push_back(b2);
         }
     }
     
-    return count;
+    return static_cast<int>(block1_array.size());
 }
 
 Partition McOperations::performMcOperation(const Partition& partition, int block1, int block2) {
@@ -38,31 +35,47 @@ Partition McOperations::performMcOperation(const Partition& partition, int block
     return result;
 }
 
-Partition McOperations::performRandomMcOperation(const Partition& partition, const Graph& graph) {
-    int block1_array[Partition::MAX_VERTICES];
-    int block2_array[Partition::MAX_VERTICES];
+bool McOperations::chooseRandomMcOperation(const Partition& partition, const Graph& graph,
+                                           Xoshiro256& rng, int& block1, int& block2) {
+    const QuotientGraph& quotient = partition.getQuotientGraph(graph);
     
-    int num_operations = findAllMcOperations(partition, graph, block1_array, block2_array);
+    // count candidates by popcount instead of listing them
+    int num_operations = 0;
+    QuotientGraph::Row blocks = quotient.getBlocks();
+    for (int b1 = blocks.popLowest(); b1 >= 0; b1 = blocks.popLowest()) {
+        num_operations += laterNeighbours(quotient, b1).count();
+    }
     
     if (num_operations == 0) {
-        // No Mc operations available, return original partition
-        return partition;
+        return false;
     }
     
-    // Choose random operation
-    static bool seeded = false;
-    if (!seeded) {
-        srand(time(nullptr));
-        seeded = true;
+    // Choose random operation from this chain's stream, in findAllMcOperations order
+    int chosen_index = static_cast<int>(rng.below(static_cast<uint32_t>(num_operations)));
+    blocks = quotient.getBlocks();
+    for (int b1 = blocks.popLowest(); b1 >= 0; b1 = blocks.popLowest()) {
+        QuotientGraph::Row later = laterNeighbours(quotient, b1);
+        int row_count = later.count();
+        if (chosen_index < row_count) {
+            block1 = b1;
+            for (block2 = later.popLowest(); chosen_index > 0; chosen_index--) {
+                block2 = later.popLowest();
+            }
+            break;
+        }
+        chosen_index -= row_count;
     }
     
-    int chosen_index = rand() % num_operations;
-    int block1 = block1_array[chosen_index];
-    int block2 = block2_array[chosen_index];
-    
-    if (VERBOSE_MC_OPERATIONS) {
-        printf("Performing Mc operation: merging block %d with block %d\n", block1, block2);
+    QI_TRACE(Mc, Debug, "Performing Mc operation: merging block %d with block %d\n", block1, block2);
+    return true;
+}
+
+Partition McOperations::performRandomMcOperation(const Partition& partition, const Graph& graph,
+                                                 Xoshiro256& rng) {
+    int block1, block2;
+    if (!chooseRandomMcOperation(partition, graph, rng, block1, block2)) {
+        // No Mc operations available, return original partition
+        return partition;
     }
-    
     return performMcOperation(partition, block1, block2);
 }
\ No newline at end of file
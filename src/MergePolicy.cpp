@@ -0,0 +1,101 @@
+#include "../include/MergePolicy.h"
+#include "../include/McOperations.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// uniform double in [0, 1) from the top 53 bits
+double unitInterval(Xoshiro256& rng) {
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+} // namespace
+
+bool parseMergePolicy(const std::string& name, MergePolicy& policy) {
+    if (name == "uniform") policy = MergePolicy::Uniform;
+    else if (name == "greedy") policy = MergePolicy::Greedy;
+    else if (name == "anneal") policy = MergePolicy::Anneal;
+    else if (name == "beam") policy = MergePolicy::Beam;
+    else return false;
+    return true;
+}
+
+const char* mergePolicyName(MergePolicy policy) {
+    switch (policy) {
+    case MergePolicy::Greedy: return "greedy";
+    case MergePolicy::Anneal: return "anneal";
+    case MergePolicy::Beam: return "beam";
+    default: return "uniform";
+    }
+}
+
+MergeSelector::MergeSelector(const Graph& graph, MergePolicy policy) : graph_(graph), policy_(policy) {
+    log_.reserve(1);
+}
+
+// cheap interval of every child, merging on a copy so the chain keeps its witness cover
+void MergeSelector::scoreCandidates(const Partition& partition, int num_operations) {
+    Partition scratch = partition;
+    scores_.resize(num_operations);
+    for (int i = 0; i < num_operations; i++) {
+        scratch.mergeBlocks(block1_array_[i], block2_array_[i], log_);
+        scores_[i] = scratch.estimateQiBounds(graph_);
+        scratch.undoMerge(log_);
+    }
+}
+
+bool MergeSelector::choose(const Partition& partition, Xoshiro256& rng, int& block1, int& block2) {
+    if (policy_ == MergePolicy::Uniform) {
+        return McOperations::chooseRandomMcOperation(partition, graph_, rng, block1, block2);
+    }
+
+    int num_operations = McOperations::findAllMcOperations(partition, graph_, block1_array_, block2_array_);
+    if (num_operations == 0) return false;
+    scoreCandidates(partition, num_operations);
+
+    int best_upper = scores_[0].upper;
+    for (const QiBounds& score : scores_) best_upper = std::min(best_upper, score.upper);
+
+    // annealing: over candidates weighted by how far their upper bound is from the best
+    int n = graph_.num_vertices;
+    double progress = (n > graph_.critical_k)
+                          ? static_cast<double>(n - partition.getNumBlocks()) / (n - graph_.critical_k) : 1.0;
+    double temperature = ANNEAL_TEMPERATURE * (1.0 - progress);
+    int chosen = -1;
+    if (policy_ == MergePolicy::Anneal && temperature > 0) {
+        weights_.resize(num_operations);
+        double total = 0;
+        for (int i = 0; i < num_operations; i++) {
+            weights_[i] = std::exp(-(scores_[i].upper - best_upper) / temperature);
+            total += weights_[i];
+        }
+        double target = unitInterval(rng) * total;
+        for (chosen = 0; chosen < num_operations - 1 && target >= weights_[chosen]; chosen++) {
+            target -= weights_[chosen];
+        }
+    } else {
+        // greedy (and annealing at zero temperature): a random one of the best
+        int best_lower = n;
+        int ties = 0;
+        for (const QiBounds& score : scores_) {
+            if (score.upper != best_upper) continue;
+            if (score.lower < best_lower) {
+                best_lower = score.lower;
+                ties = 0;
+            }
+            if (score.lower == best_lower) ties++;
+        }
+        int pick = static_cast<int>(rng.below(static_cast<uint32_t>(ties)));
+        for (chosen = 0; chosen < num_operations; chosen++) {
+            if (scores_[chosen].upper == best_upper && scores_[chosen].lower == best_lower && pick-- == 0) break;
+        }
+    }
+
+    block1 = block1_array_[chosen];
+    block2 = block2_array_[chosen];
+    QI_TRACE(Mc, Debug, "Policy %s: merging block %d with block %d (child qi in [%d, %d])\n",
+             mergePolicyName(policy_), block1, block2, scores_[chosen].lower, scores_[chosen].upper);
+    return true;
+}
@@ -3,41 +3,145 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <cstdio>
-#include <vector>
-#include <exception>
-#include <map>
 #include <string>
-#include "dsatur.hpp"
+#include "../include/BlockSet.h"
+#include "../include/Dsatur.h"
+#include "../include/ExactQiSolver.h"
+#include "../include/QiBranchAndBound.h"
+#include "../include/QiCache.h"
+#include "../include/QiCounters.h"
+#include "../include/QuotientGraph.h"
+#include "../include/QuotientKernel.h"
+#include "../include/Trace.h"
+#if QI_SAT_BACKEND
+#include "../include/SatColoring.h"
+#endif
 
-Partition::Partition() : num_vertices_(0), qi_calculated_(false) {
-    std::fill(partition_, partition_ + MAX_VERTICES, 0);
+static_assert(Partition::MAX_VERTICES <= QuotientGraph::MAX_BLOCKS, "quotient rows must hold every block label");
+
+namespace {
+
+// copy the kernel onto per-block neighbour masks over consecutive indices and solve exactly
+// (kernel_colors receives the best cover found, by kernel index)
+template <int Words>
+int solveExactQi(const QuotientKernel& kernel, int min_required_qi, int* kernel_colors) {
+    BlockSet<Words> kernel_adj[BlockSet<Words>::CAPACITY];
+    kernel.copyAdjacency(kernel_adj);
+    
+    ExactQiSolver<Words> solver(kernel_adj, kernel.getBlockCount());
+    int qi = solver.solve(min_required_qi);
+    for (int i = 0; i < kernel.getBlockCount(); i++) {
+        kernel_colors[i] = solver.getColor(i);
+    }
+    return qi;
+}
+
+// same copy, but decide the threshold by clique / DSATUR branch and bound
+template <int Words>
+QiBounds solveQiBounds(const QuotientKernel& kernel, int min_required_qi, SearchBudget* budget,
+                       int num_threads, int* kernel_colors) {
+    BlockSet<Words> kernel_adj[BlockSet<Words>::CAPACITY];
+    kernel.copyAdjacency(kernel_adj);
+    
+    QiBranchAndBound<Words> solver(kernel_adj, kernel.getBlockCount(), budget);
+    solver.setThreads(num_threads);
+    QiBounds bounds = solver.solve(min_required_qi);
+    for (int i = 0; i < kernel.getBlockCount(); i++) {
+        kernel_colors[i] = solver.hasColoring() ? solver.getColor(i) : i;
+    }
+    return bounds;
+}
+
+// same copy, colored greedily by DSATUR
+template <int Words>
+int dsaturColors(const QuotientKernel& kernel, int* kernel_colors) {
+    BlockSet<Words> kernel_adj[BlockSet<Words>::CAPACITY];
+    kernel.copyAdjacency(kernel_adj);
+    
+    Dsatur<Words> dsatur(kernel_adj, kernel.getBlockCount());
+    int colors = dsatur.color();
+    for (int i = 0; i < kernel.getBlockCount(); i++) {
+        kernel_colors[i] = dsatur.getColor(i);
+    }
+    return colors;
+}
+
+// cheap interval with no search: DSATUR colors bound qi from below, a greedy clique
+// (grown by the candidate that keeps most candidates) from above
+template <int Words>
+QiBounds estimateBounds(const QuotientGraph& quotient) {
+    BlockSet<Words> adj[BlockSet<Words>::CAPACITY];
+    int block_labels[QuotientGraph::MAX_BLOCKS];
+    int count = quotient.compact(adj, block_labels);
+    
+    Dsatur<Words> dsatur(adj, count);
+    int colors = dsatur.color();
+    
+    int clique = QuotientKernel::growClique(adj, BlockSet<Words>::none(), BlockSet<Words>::firstN(count)).count();
+    return {count - colors, count - clique};
 }
 
+} // namespace
+
+int Partition::search_threads_ = 1;
+
+Partition::Partition()
+    : num_vertices_(0), label_bound_(0), num_blocks_(0), witness_colors_(0), witness_valid_(false),
+      qi_calculated_(false) {}
+
 Partition::Partition(const int* partition_array, int num_vertices) 
-    : num_vertices_(num_vertices), qi_calculated_(false) {
+    : partition_(partition_array, partition_array + num_vertices), num_vertices_(num_vertices),
+      witness_colors_(0), witness_valid_(false), qi_calculated_(false) {
     assert(num_vertices <= MAX_VERTICES);
-    std::copy(partition_array, partition_array + num_vertices, partition_);
-    std::fill(partition_ + num_vertices, partition_ + MAX_VERTICES, 0);
+    rebuildBlockLists();
 }
 
-
-Partition::Partition(const Partition& other) {
-    copyFrom(other);
+void Partition::rebuildBlockLists() {
+    label_bound_ = 0;
+    for (int v = 0; v < num_vertices_; v++) {
+        assert(partition_[v] >= 0 && partition_[v] < MAX_VERTICES);
+        label_bound_ = std::max(label_bound_, partition_[v] + 1);
+    }
+    block_head_.assign(label_bound_, -1);
+    block_tail_.assign(label_bound_, -1);
+    label_slot_.assign(label_bound_, -1);
+    next_in_block_.assign(num_vertices_, -1);
+    active_labels_.assign(num_vertices_, -1);
+    
+    witness_valid_ = false; // labels changed wholesale
+    
+    // ascending vertex order within each block
+    num_blocks_ = 0;
+    for (int v = 0; v < num_vertices_; v++) {
+        int label = partition_[v];
+        if (block_tail_[label] < 0) {
+            block_head_[label] = v;
+            addActiveLabel(label);
+        } else {
+            next_in_block_[block_tail_[label]] = v;
+        }
+        block_tail_[label] = v;
+    }
 }
 
-Partition& Partition::operator=(const Partition& other) {
-    if (this != &other) {
-        copyFrom(other);
+// relabel the list segment starting at first_vertex
+void Partition::relabelBlock(int first_vertex, int label) {
+    for (int v = first_vertex; v >= 0; v = next_in_block_[v]) {
+        partition_[v] = label;
     }
-    return *this;
 }
 
-void Partition::copyFrom(const Partition& other) {
-    num_vertices_ = other.num_vertices_;
-    std::copy(other.partition_, other.partition_ + MAX_VERTICES, partition_);
-    qi_calculated_ = other.qi_calculated_;
-    qi_number_ = other.qi_number_;
+void Partition::addActiveLabel(int label) {
+    label_slot_[label] = num_blocks_;
+    active_labels_[num_blocks_++] = label;
+}
+
+// swap-remove; undoMerge reverses this using the saved slot
+void Partition::removeActiveLabel(int label) {
+    int slot = label_slot_[label];
+    int last = active_labels_[--num_blocks_];
+    active_labels_[slot] = last;
+    label_slot_[last] = slot;
 }
 
 void Partition::invalidateQiCache() {
@@ -53,665 +157,578 @@ void Partition::setLabel(int vertex, int label) {
     assert(vertex >= 0 && vertex < num_vertices_);
     if (partition_[vertex] != label) {
         partition_[vertex] = label;
+        rebuildBlockLists();
+        quotient_.clear();
         invalidateQiCache();
     }
 }
 
-int Partition::getNumBlocks() const {
-    bool used[MAX_VERTICES] = {false};
-    for (int v = 0; v < num_vertices_; v++) {
-        used[partition_[v]] = true;
-    }
-    int count = 0;
-    for (int i = 0; i < MAX_VERTICES; i++) {
-        if (used[i]) count++;
+// vertices come out in list order, which is ascending only until blocks are merged
+void Partition::getBlockVertices(int block_label, int* vertices, int& count) const {
+    count = 0;
+    if (block_label < 0 || block_label >= label_bound_) return;
+    for (int v = block_head_[block_label]; v >= 0; v = next_in_block_[v]) {
+        vertices[count++] = v;
     }
-    return count;
 }
 
-void Partition::getBlockVertices(int block_label, int* vertices, int& count) const {
-    count = 0;
+void Partition::getCanonicalLabels(int* labels) const {
+    int first_vertex[MAX_VERTICES];
+    std::fill(first_vertex, first_vertex + label_bound_, -1);
     for (int v = 0; v < num_vertices_; v++) {
-        if (partition_[v] == block_label) {
-            vertices[count++] = v;
+        int label = partition_[v];
+        if (first_vertex[label] < 0) {
+            first_vertex[label] = v;
         }
+        labels[v] = first_vertex[label];
     }
 }
 
 void Partition::calculateQiNumber(const Graph& graph) {
     if (qi_calculated_) return;
-    if (VERBOSE_QI_DEBUG) {
-        printf("Entering calculateQiNumber() with %d blocks...\n", getNumBlocks());
-        fflush(stdout);
-    }
+    QI_TRACE(Qi, Debug, "Entering calculateQiNumber() with %d blocks...\n", getNumBlocks());
     qi_number_ = calculateQiNumberInternal(graph);
     qi_calculated_ = true;
 }
 
 void Partition::calculateQiNumber(const Graph& graph, int min_required_qi) {
     if (qi_calculated_) return;
-    if (VERBOSE_QI_DEBUG) {
-        printf("Entering calculateQiNumber() with early stopping: %d blocks, min_required=%d...\n", getNumBlocks(), min_required_qi);
-        fflush(stdout);
-    }
-    qi_number_ = calculateQiNumberInternal(graph, min_required_qi);
+    QI_TRACE(Qi, Debug, "Entering calculateQiNumber() with early stopping: %d blocks, min_required=%d...\n",
+             getNumBlocks(), min_required_qi);
+    qi_number_ = calculateQiNumberInternal(graph, min_required_qi, nullptr);
+    qi_calculated_ = true;
+}
+
+void Partition::calculateQiNumber(const Graph& graph, int min_required_qi, SearchBudget& budget) {
+    // a result cut short by an earlier budget may be improved by this one
+    if (qi_calculated_ && !qi_bounds_.exhausted) return;
+    qi_number_ = calculateQiNumberInternal(graph, min_required_qi, &budget);
     qi_calculated_ = true;
 }
 
 bool Partition::areBlocksConnectedInQuotient(const Graph& graph, int block1, int block2) const {
     if (block1 == block2) return false;
-    
-    const int* adj_matrix = graph.getAdjMatrix();
-    
-    // Check if any vertex in block1 is connected to any vertex in block2
-    for (int u = 0; u < num_vertices_; u++) {
-        if (partition_[u] != block1) continue;
-        for (int v = 0; v < num_vertices_; v++) {
-            if (partition_[v] != block2) continue;
-            if (adj_matrix[u * num_vertices_ + v]) {
-                return true;
-            }
-        }
+    return getQuotientGraph(graph).areAdjacent(block1, block2);
+}
+
+const QuotientGraph& Partition::getQuotientGraph(const Graph& graph) const {
+    if (!quotient_.isBuilt()) {
+        quotient_.build(graph, partition_.data(), num_vertices_);
     }
-    return false;
+    return quotient_;
 }
 
 void Partition::mergeBlocks(int block1, int block2) {
     if (block1 == block2) return;
-    
-    // Merge block2 into block1
-    for (int v = 0; v < num_vertices_; v++) {
-        if (partition_[v] == block2) {
-            partition_[v] = block1;
+    if (block2 >= label_bound_ || block_head_[block2] < 0) return; // nothing to move
+    
+    // Merge block2 into block1: relabel its vertices and splice its list onto block1's
+    relabelBlock(block_head_[block2], block1);
+    if (block1 >= label_bound_ || block_head_[block1] < 0) {
+        // block1 was unused, so this only renames block2
+        assert(block1 >= 0 && block1 < MAX_VERTICES);
+        if (block1 >= label_bound_) {
+            label_bound_ = block1 + 1;
+            block_head_.resize(label_bound_, -1);
+            block_tail_.resize(label_bound_, -1);
+            label_slot_.resize(label_bound_, -1);
+        }
+        block_head_[block1] = block_head_[block2];
+        addActiveLabel(block1);
+        quotient_.clear();
+        witness_valid_ = false;
+    } else {
+        next_in_block_[block_tail_[block1]] = block_head_[block2];
+        
+        // a built quotient only changes by folding one row into another
+        if (quotient_.isBuilt()) {
+            quotient_.mergeBlocks(block1, block2);
+            if (witness_valid_) recolorMergedBlock(block1, block2);
+        } else {
+            witness_valid_ = false;
         }
     }
+    block_tail_[block1] = block_tail_[block2];
+    block_head_[block2] = block_tail_[block2] = -1;
+    removeActiveLabel(block2);
     invalidateQiCache();
 }
 
+void Partition::mergeBlocks(int block1, int block2, MergeLog& log) {
+    assert(block1 != block2);
+    assert(block1 < label_bound_ && block_head_[block1] >= 0);
+    assert(block2 < label_bound_ && block_head_[block2] >= 0);
+    
+    MergeLog::Entry entry;
+    entry.block1 = block1;
+    entry.block2 = block2;
+    entry.block1_tail = block_tail_[block1];
+    entry.block2_slot = label_slot_[block2];
+    entry.quotient_built = quotient_.isBuilt();
+    if (entry.quotient_built) {
+        entry.block1_row = quotient_.getNeighbours(block1);
+        entry.block2_row = quotient_.getNeighbours(block2);
+    }
+    entry.qi_calculated = qi_calculated_;
+    entry.qi_number = qi_number_;
+    entry.qi_bounds = qi_bounds_;
+    log.entries_.push_back(entry);
+    
+    mergeBlocks(block1, block2);
+}
+
+void Partition::undoMerge(MergeLog& log) {
+    assert(!log.empty());
+    MergeLog::Entry entry = log.entries_.back();
+    log.entries_.pop_back();
+    int block1 = entry.block1;
+    int block2 = entry.block2;
+    
+    // split block2's vertices back off the end of block1's list
+    block_head_[block2] = next_in_block_[entry.block1_tail];
+    block_tail_[block2] = block_tail_[block1];
+    next_in_block_[entry.block1_tail] = -1;
+    block_tail_[block1] = entry.block1_tail;
+    relabelBlock(block_head_[block2], block2);
+    
+    // put block2 back in its old slot, returning the label swapped there to the end
+    int moved = active_labels_[entry.block2_slot];
+    label_slot_[moved] = num_blocks_;
+    active_labels_[num_blocks_++] = moved;
+    label_slot_[block2] = entry.block2_slot;
+    active_labels_[entry.block2_slot] = block2;
+    
+    if (entry.quotient_built && quotient_.isBuilt()) {
+        quotient_.unmergeBlocks(block1, block2, entry.block1_row, entry.block2_row);
+    } else {
+        quotient_.clear();
+    }
+    qi_calculated_ = entry.qi_calculated;
+    qi_number_ = entry.qi_number;
+    qi_bounds_ = entry.qi_bounds;
+    witness_valid_ = false; // may have been replaced since the merge
+}
+
+// give the merged block the lowest color none of its new neighbours use, preferring
+// colors that are already in use, so the cover grows by at most one color
+void Partition::recolorMergedBlock(int block1, int block2) {
+    int old_colors[2] = {witness_color_[block1], witness_color_[block2]};
+    witness_color_[block2] = -1;
+    for (int color : old_colors) {
+        if (--color_size_[color] == 0) witness_colors_--;
+    }
+    
+    QuotientGraph::Row blocked = QuotientGraph::Row::none();
+    QuotientGraph::Row neighbours = quotient_.getNeighbours(block1);
+    for (int label = neighbours.popLowest(); label >= 0; label = neighbours.popLowest()) {
+        blocked.set(witness_color_[label]);
+    }
+    
+    int num_ids = static_cast<int>(color_size_.size());
+    int chosen = -1;
+    for (int color = 0; color < num_ids; color++) {
+        if (blocked.test(color)) continue;
+        if (color_size_[color] > 0) {
+            chosen = color;
+            break;
+        }
+        if (chosen < 0) chosen = color; // empty: only if no used color fits
+    }
+    if (chosen < 0) {
+        chosen = num_ids;
+        color_size_.push_back(0);
+    }
+    witness_color_[block1] = chosen;
+    if (color_size_[chosen]++ == 0) witness_colors_++;
+}
+
 int Partition::calculateQiNumberInternal(const Graph& graph) const {
     int k = getNumBlocks();
     
-    if (VERBOSE_QI_DEBUG) {
-        printf("=== QI CALCULATION (k=%d) ===\n", k);
-        printf("Algorithm selection: %s\n", (k <= 16) ? "EXACT (exhaustive)" : "FAST (chromatic number)");
-        fflush(stdout);
+    if (k == 1) {
+        qi_bounds_ = {0, 0};
+        return 0; // Single block is q-complete
     }
     
-    if (k == 1) return 0; // Single block is q-complete
-    
-    // Build quotient graph for SmallGraph
-    // Get list of used block labels (may not be consecutive)
-    int block_labels[MAX_VERTICES];
-    int label_count = 0;
-    bool seen[MAX_VERTICES] = {false};
+    // the exact / fast choice is made on the irreducible core
+    QuotientKernel kernel(getQuotientGraph(graph));
+    int core = kernel.getBlockCount();
+    QI_TRACE(Qi, Debug, "=== QI CALCULATION (k=%d, kernel=%d) ===\nAlgorithm selection: %s\n", k, core,
+             (core <= EXACT_QI_MAX_BLOCKS) ? "EXACT (exhaustive)" : "FAST (chromatic number)");
     
-    for (int v = 0; v < num_vertices_; v++) {
-        int label = partition_[v];
-        if (!seen[label]) {
-            seen[label] = true;
-            block_labels[label_count++] = label;
-        }
+    if (core <= EXACT_QI_MAX_BLOCKS) {
+        QiCounters::local().exact_path++;
+        int exact_qi = calculateQiNumberInternalExhaustive(kernel);
+        qi_bounds_ = {exact_qi, exact_qi};
+        return exact_qi;
     }
     
-    // Create mapping from block labels to consecutive indices for SmallGraph
-    int label_to_index[MAX_VERTICES];
-    for (int i = 0; i < MAX_VERTICES; i++) {
-        label_to_index[i] = -1;
-    }
-    for (int i = 0; i < label_count; i++) {
-        label_to_index[block_labels[i]] = i;
-    }
-    
-    // Build quotient graph adjacency matrix with consecutive indices
-    std::vector<std::vector<bool>> quotient_adj(label_count, std::vector<bool>(label_count, false));
-    
-    // Check all edges in original graph to build quotient graph
-    const int* adj_matrix = graph.getAdjMatrix();
-    
-    if (VERBOSE_QI_DEBUG) {
-        printf("\n=== QI CALCULATION DEBUG (ChromaticNumber) ===\n");
-        printf("Partition blocks (%d total):\n", label_count);
+    if (Trace::enabled(TraceCategory::Qi, TraceLevel::Detail)) {
+        // Use the maintained quotient graph, copied onto consecutive indices
+        int block_labels[MAX_VERTICES];
+        QuotientGraph::Row quotient_adj[MAX_VERTICES];
+        int label_count = getQuotientGraph(graph).compact(quotient_adj, block_labels);
+        
+        // one write per line, so lines from concurrent chains stay whole
+        Trace::write("\n=== QI CALCULATION DEBUG (ChromaticNumber) ===\nPartition blocks (%d total):\n", label_count);
         for (int i = 0; i < label_count; i++) {
-            int label = block_labels[i];
-            printf("  Block %d: vertices ", label);
-            for (int v = 0; v < num_vertices_; v++) {
-                if (partition_[v] == label) {
-                    printf("%d ", v);
-                }
+            int vertices[MAX_VERTICES];
+            int count;
+            getBlockVertices(block_labels[i], vertices, count);
+            std::sort(vertices, vertices + count);
+            std::string line = "  Block " + std::to_string(block_labels[i]) + ": vertices";
+            for (int j = 0; j < count; j++) {
+                line += ' ';
+                line += std::to_string(vertices[j]);
             }
-            printf("\n");
+            Trace::write("%s\n", line.c_str());
         }
-    }
-    
-    for (int u = 0; u < num_vertices_; u++) {
-        for (int v = u + 1; v < num_vertices_; v++) {
-            if (adj_matrix[u * num_vertices_ + v] == 1) {
-                int block_u = partition_[u];
-                int block_v = partition_[v];
-                
-                if (block_u != block_v) {
-                    int idx_u = label_to_index[block_u];
-                    int idx_v = label_to_index[block_v];
-                    quotient_adj[idx_u][idx_v] = true;
-                    quotient_adj[idx_v][idx_u] = true;
-                }
-            }
-        }
-    }
-    
-    if (VERBOSE_QI_DEBUG) {
-        printf("Quotient graph edges:\n");
+        
+        Trace::write("Quotient graph edges:\n");
         int edge_count = 0;
         for (int i = 0; i < label_count; i++) {
             for (int j = i + 1; j < label_count; j++) {
-                if (quotient_adj[i][j]) {
-                    printf("  Block %d -- Block %d\n", block_labels[i], block_labels[j]);
+                if (quotient_adj[i].test(j)) {
+                    Trace::write("  Block %d -- Block %d\n", block_labels[i], block_labels[j]);
                     edge_count++;
                 }
             }
         }
-        printf("Quotient graph has %d vertices and %d edges\n", label_count, edge_count);
+        Trace::write("Quotient graph has %d vertices and %d edges\n", label_count, edge_count);
     }
     
-    // Convert to graph-coloring library format and calculate chromatic number
-    try {
-        // Build graph in format expected by graph-coloring library
-        std::map<std::string, std::vector<std::string>> coloring_graph;
-        
-        // Initialize all vertices
-        for (int i = 0; i < label_count; i++) {
-            coloring_graph[std::to_string(i)] = std::vector<std::string>();
-        }
-        
-        // Add edges to graph
-        for (int i = 0; i < label_count; i++) {
-            for (int j = i + 1; j < label_count; j++) {
-                if (quotient_adj[i][j]) {
-                    coloring_graph[std::to_string(i)].push_back(std::to_string(j));
-                    coloring_graph[std::to_string(j)].push_back(std::to_string(i));
-                }
-            }
-        }
-        
-        // Use DSATUR algorithm to find chromatic number
-        GraphColoring::Dsatur dsatur(coloring_graph);
-        dsatur.color();
-        
-        // Get chromatic number
-        int chromatic_number = dsatur.get_num_colors();
-        
-        // qi = k - chromatic_number  
-        int qi = k - chromatic_number;
-        
-        if (VERBOSE_QI_DEBUG) {
-            printf("Chromatic number (DSATUR): %d\n", chromatic_number);
-            printf("qi = k - chromatic_number = %d - %d = %d\n", k, chromatic_number, qi);
-            printf("=== END QI DEBUG ===\n\n");
-        }
-        
-        return qi;
-        
-    } catch (const std::exception& e) {
-        if (VERBOSE_QI_DEBUG) {
-            printf("Graph coloring error: %s\n", e.what());
-            printf("Falling back to exhaustive calculation...\n");
-        }
-        
-        // Fallback to exhaustive calculation if coloring fails
-        return calculateQiNumberInternalExhaustive(graph);
-    }
+    // Use DSATUR algorithm to find chromatic number
+    QiCounters::local().fast_path++;
+    int chromatic_number = calculateDsaturColors(kernel);
+    
+    // qi = k - chromatic_number  
+    int qi = k - chromatic_number;
+    qi_bounds_ = {qi, k - 1}; // DSATUR only bounds chi from above
+    
+    QI_TRACE(Qi, Info, "Chromatic number (DSATUR): %d\nqi = k - chromatic_number = %d - %d = %d\n",
+             chromatic_number, k, chromatic_number, qi);
+    
+    return qi;
 }
 
-int Partition::calculateQiNumberInternalExhaustive(const Graph& graph) const {
+int Partition::calculateQiNumberInternalExhaustive(const QuotientKernel& kernel) const {
     int k = getNumBlocks();
     
     if (k == 1) return 0; // Single block is q-complete
     
-    // Build quotient graph adjacency matrix
-    bool quotient_adj[MAX_VERTICES][MAX_VERTICES];
-    for (int i = 0; i < MAX_VERTICES; i++) {
-        for (int j = 0; j < MAX_VERTICES; j++) {
-            quotient_adj[i][j] = false;
-        }
-    }
+    QI_TRACE(Qi, Debug, "Starting exhaustive search for optimal qi...\n");
     
-    // Get list of used block labels (may not be consecutive)
-    int block_labels[MAX_VERTICES];
-    int label_count = 0;
-    bool seen[MAX_VERTICES] = {false};
+    // qi never exceeds k - 1, so a threshold of k disables early stopping
+    int max_qi = calculateQiNumberExact(kernel, k);
     
-    for (int v = 0; v < num_vertices_; v++) {
-        int label = partition_[v];
-        if (!seen[label]) {
-            seen[label] = true;
-            block_labels[label_count++] = label;
-        }
-    }
+    QI_TRACE(Qi, Info, "Exhaustive fallback result: qi = %d\n", max_qi);
     
-    // Check all edges in original graph to build quotient graph
-    const int* adj_matrix = graph.getAdjMatrix();
+    return max_qi;
+}
+
+int Partition::calculateQiNumberInternal(const Graph& graph, int min_required_qi, SearchBudget* budget) const {
+    int k = getNumBlocks();
     
-    for (int u = 0; u < num_vertices_; u++) {
-        for (int v = u + 1; v < num_vertices_; v++) {
-            if (adj_matrix[u * num_vertices_ + v] == 1) {
-                int block_u = partition_[u];
-                int block_v = partition_[v];
-                
-                if (block_u != block_v) {
-                    quotient_adj[block_u][block_v] = true;
-                    quotient_adj[block_v][block_u] = true;
-                }
+    QI_TRACE(Qi, Debug, "=== QI CALCULATION WITH EARLY STOPPING (k=%d, min_required=%d) ===\n", k, min_required_qi);
+    
+    if (k == 1) {
+        qi_bounds_ = {0, 0};
+        return 0; // Single block is q-complete
+    }
+    
+    // the cover carried over from the previous step may already meet the threshold
+    int witness_qi = getWitnessQi();
+    if (witness_qi >= min_required_qi && min_required_qi > 0) {
+        QI_TRACE(Qi, Info, "Witness cover from the previous step: qi >= %d (required >= %d)\n", witness_qi, min_required_qi);
+        QiCounters::local().witness_hits++;
+        qi_bounds_ = {witness_qi, k - 1};
+        return witness_qi;
+    }
+    
+    // a quotient isomorphic to one solved before starts from the cached interval
+    QiCache& cache = QiCache::global();
+    bool cacheable = cache.isEnabled() && k >= QiCache::MIN_BLOCKS && k <= QiCache::MAX_BLOCKS;
+    std::string key;
+    int order[QiCache::MAX_BLOCKS];
+    int label_colors[MAX_VERTICES];
+    QiCache::Entry entry;
+    bool hit = false;
+    if (cacheable) {
+        key = QiCache::canonicalKey(getQuotientGraph(graph), order);
+        QiCounters::local().cache_lookups++;
+        hit = cache.lookup(key, entry);
+    }
+    if (hit) {
+        for (int i = 0; i < k; i++) label_colors[order[i]] = entry.colors[i];
+        adoptWitness(label_colors);
+        QiBounds bounds = entry.bounds;
+        bounds.lower = std::max(bounds.lower, getWitnessQi());
+        if (bounds.isExact() ||
+            (min_required_qi > 0 && (bounds.certifies(min_required_qi) || bounds.refutes(min_required_qi)))) {
+            QI_TRACE(Qi, Info, "Cached qi interval: qi in [%d, %d] (required >= %d)\n", bounds.lower, bounds.upper, min_required_qi);
+            QiCounters::local().cache_hits++;
+            qi_bounds_ = bounds;
+            return bounds.certifies(min_required_qi) ? bounds.lower : bounds.upper;
+        }
+    }
+    
+    int qi = searchQiNumber(graph, min_required_qi, budget, witness_qi);
+    
+    if (hit) {
+        // the cached interval may close what the search left open
+        qi_bounds_.lower = std::max(qi_bounds_.lower, entry.bounds.lower);
+        qi_bounds_.upper = std::min(qi_bounds_.upper, entry.bounds.upper);
+        if (qi == -1 && qi_bounds_.certifies(min_required_qi)) qi = qi_bounds_.lower;
+        if (qi == -1 && qi_bounds_.refutes(min_required_qi)) qi = qi_bounds_.upper;
+    }
+    if (cacheable) {
+        // the stored lower bound is the one the witness cover proves, so it travels
+        // with its coloring; colors are renumbered to fit a byte
+        QiCache::Entry learned;
+        learned.bounds = {0, qi_bounds_.upper};
+        learned.colors.assign(k, 0);
+        if (getWitnessCover(label_colors)) {
+            learned.bounds.lower = getWitnessQi();
+            int renumber[MAX_VERTICES];
+            std::fill(renumber, renumber + MAX_VERTICES, -1);
+            int colors = 0;
+            for (int i = 0; i < k; i++) {
+                int& color = renumber[label_colors[order[i]]];
+                if (color < 0) color = colors++;
+                learned.colors[i] = static_cast<uint8_t>(color);
             }
+        } else {
+            for (int i = 0; i < k; i++) learned.colors[i] = static_cast<uint8_t>(i);
         }
+        cache.store(key, learned);
     }
-    
-    // Exact algorithm: try all possible ways to partition blocks into disjoint independent sets
-    int max_qi = 0;
-    
-    // Use recursive backtracking to find optimal partition
-    bool used[MAX_VERTICES] = {false};
-    
-    if (VERBOSE_QI_DEBUG) {
-        printf("Starting exhaustive search for optimal qi...\n");
-    }
-    
-    findOptimalQi(block_labels, label_count, quotient_adj, used, 0, 0, max_qi);
-    
-    if (VERBOSE_QI_DEBUG) {
-        printf("Exhaustive fallback result: qi = %d\n", max_qi);
-    }
-    
-    return max_qi;
+    return qi;
 }
 
-int Partition::calculateQiNumberInternal(const Graph& graph, int min_required_qi) const {
+// the qi search itself, once the witness cover and the cache did not decide the threshold
+int Partition::searchQiNumber(const Graph& graph, int min_required_qi, SearchBudget* budget, int witness_qi) const {
     int k = getNumBlocks();
     
-    if (VERBOSE_QI_DEBUG) {
-        printf("=== QI CALCULATION WITH EARLY STOPPING (k=%d, min_required=%d) ===\n", k, min_required_qi);
-    }
-    
-    if (k == 1) return 0; // Single block is q-complete
+    // the solvers only see the irreducible core, and the size cutoff applies to it
+    QuotientKernel kernel(getQuotientGraph(graph));
+    QI_TRACE(Qi, Debug, "Kernel: %d of %d blocks left, qi offset %d\n", kernel.getBlockCount(), k,
+             kernel.getQiOffset());
     
     // For larger graphs, try chromatic number approach first
-    if (k > 15) {
-        if (VERBOSE_QI_DEBUG) {
-            printf("Algorithm: FAST (DSATUR chromatic number) - attempting early exit\n");
-        }
-        try {
-            // Build quotient graph for SmallGraph (same as in main method)
-            int block_labels[MAX_VERTICES];
-            int label_count = 0;
-            bool seen[MAX_VERTICES] = {false};
-            
-            for (int v = 0; v < num_vertices_; v++) {
-                int label = partition_[v];
-                if (!seen[label]) {
-                    seen[label] = true;
-                    block_labels[label_count++] = label;
-                }
-            }
-            
-            // Create mapping from block labels to consecutive indices
-            int label_to_index[MAX_VERTICES];
-            for (int i = 0; i < MAX_VERTICES; i++) {
-                label_to_index[i] = -1;
-            }
-            for (int i = 0; i < label_count; i++) {
-                label_to_index[block_labels[i]] = i;
-            }
-            
-            // Build quotient graph adjacency matrix
-            std::vector<std::vector<bool>> quotient_adj(label_count, std::vector<bool>(label_count, false));
-            const int* adj_matrix = graph.getAdjMatrix();
-            
-            for (int u = 0; u < num_vertices_; u++) {
-                for (int v = u + 1; v < num_vertices_; v++) {
-                    if (adj_matrix[u * num_vertices_ + v] == 1) {
-                        int block_u = partition_[u];
-                        int block_v = partition_[v];
-                        
-                        if (block_u != block_v) {
-                            int idx_u = label_to_index[block_u];
-                            int idx_v = label_to_index[block_v];
-                            quotient_adj[idx_u][idx_v] = true;
-                            quotient_adj[idx_v][idx_u] = true;
-                        }
-                    }
-                }
-            }
-            
-            // Convert to graph-coloring library format
-            std::map<std::string, std::vector<std::string>> coloring_graph;
-            
-            // Initialize all vertices
-            for (int i = 0; i < label_count; i++) {
-                coloring_graph[std::to_string(i)] = std::vector<std::string>();
-            }
-            
-            // Add edges
-            for (int i = 0; i < label_count; i++) {
-                for (int j = i + 1; j < label_count; j++) {
-                    if (quotient_adj[i][j]) {
-                        coloring_graph[std::to_string(i)].push_back(std::to_string(j));
-                        coloring_graph[std::to_string(j)].push_back(std::to_string(i));
-                    }
-                }
-            }
-            
-            // Use DSATUR to find chromatic number
-            GraphColoring::Dsatur dsatur(coloring_graph);
-            dsatur.color();
-            int chromatic_number = dsatur.get_num_colors();
-            int qi = k - chromatic_number;
-            
-            if (VERBOSE_QI_DEBUG) {
-                printf("Fast chromatic calculation (DSATUR): qi = %d - %d = %d (required >= %d)\n", 
-                       k, chromatic_number, qi, min_required_qi);
-            }
-            
-            // If this satisfies our requirement, return it
-            if (qi >= min_required_qi) {
-                return qi;
-            }
-            
-        } catch (const std::exception& e) {
-            if (VERBOSE_QI_DEBUG) {
-                printf("Graph coloring error in fast path: %s\n", e.what());
-                printf("Returning UNDETERMINED for large graph\n");
-            }
-            return -1; // Return special value for undetermined
-        }
+    if (kernel.getBlockCount() > EXACT_QI_MAX_BLOCKS) {
+        QI_TRACE(Qi, Debug, "Algorithm: FAST (DSATUR chromatic number) - attempting early exit\n");
+        QiCounters::local().fast_path++;
+        // Use DSATUR to find chromatic number
+        int chromatic_number = calculateDsaturColors(kernel);
+        int qi = k - chromatic_number;
+        qi_bounds_ = {qi, k - 1}; // DSATUR only bounds chi from above
         
-        // If we reach here, fast algorithm didn't satisfy threshold
-        if (VERBOSE_QI_DEBUG) {
-            printf("Fast algorithm result insufficient (required=%d)\n", min_required_qi);
-            printf("Returning UNDETERMINED for large graph to avoid expensive computation\n");
+        QI_TRACE(Qi, Info, "Fast chromatic calculation (DSATUR): qi = %d - %d = %d (required >= %d)\n",
+                           k, chromatic_number, qi, min_required_qi);
+        
+        // If this satisfies our requirement, return it
+        if (qi >= min_required_qi) {
+            return qi;
         }
+        
+        // the threshold lies above the DSATUR bound: escalate to a capped branch and bound,
+        // whose clique bound alone often refutes it
+        SearchBudget capped(LARGE_QUOTIENT_SEARCH_NODES,
+                            budget ? budget->getDeadline() : SearchBudget::Clock::time_point::max());
+        QiBounds bounds = calculateQiBounds(kernel, min_required_qi, &capped);
+        bounds.lower = std::max(bounds.lower, std::max(qi, witness_qi));
+#if QI_SAT_BACKEND
+        if (!bounds.certifies(min_required_qi) && !bounds.refutes(min_required_qi)) {
+            bounds = decideQiWithSat(kernel, min_required_qi, bounds, budget);
+        }
+#endif
+        qi_bounds_ = bounds;
+        
+        QI_TRACE(Qi, Info, "Large quotient branch and bound: qi in [%d, %d]%s (required >= %d)\n",
+                           bounds.lower, bounds.upper, bounds.exhausted ? " (budget exhausted)" : "", min_required_qi);
+        if (bounds.certifies(min_required_qi)) return bounds.lower;
+        if (bounds.refutes(min_required_qi)) return bounds.upper;
         return -1; // Return special value for undetermined
     }
     
     // Fall back to exhaustive early-stopping search for small graphs only
-    if (VERBOSE_QI_DEBUG) {
-        printf("Algorithm: EXACT (exhaustive backtracking with early stopping)\n");
-    }
+    QI_TRACE(Qi, Debug, "Algorithm: EXACT (exhaustive backtracking with early stopping)\n");
     
     // Early exit: if we only need qi >= min_required_qi, we can stop early
     if (min_required_qi <= 0) return calculateQiNumberInternal(graph);
+    QiCounters::local().exact_path++;
        
-    // Build quotient graph adjacency matrix
-    bool quotient_adj[MAX_VERTICES][MAX_VERTICES];
-    for (int i = 0; i < MAX_VERTICES; i++) {
-        for (int j = 0; j < MAX_VERTICES; j++) {
-            quotient_adj[i][j] = false;
-        }
-    }
-    
-    // Get list of used block labels (may not be consecutive)
-    int block_labels[MAX_VERTICES];
-    int label_count = 0;
-    bool seen[MAX_VERTICES] = {false};
-    
-    for (int v = 0; v < num_vertices_; v++) {
-        int label = partition_[v];
-        if (!seen[label]) {
-            seen[label] = true;
-            block_labels[label_count++] = label;
-        }
-    }
+    // Use branch and bound: stops once the qi interval decides the threshold
+    QI_TRACE(Qi, Debug, "Starting branch and bound with early stopping (min_required: %d)...\n", min_required_qi);
     
-    // Check all edges in original graph to build quotient graph
-    const int* adj_matrix = graph.getAdjMatrix();
-    
-    for (int u = 0; u < num_vertices_; u++) {
-        for (int v = u + 1; v < num_vertices_; v++) {
-            if (adj_matrix[u * num_vertices_ + v] == 1) {
-                int block_u = partition_[u];
-                int block_v = partition_[v];
-                
-                if (block_u != block_v) {
-                    quotient_adj[block_u][block_v] = true;
-                    quotient_adj[block_v][block_u] = true;
-                }
-            }
-        }
+    QiBounds bounds = calculateQiBounds(kernel, min_required_qi, budget);
+    bounds.lower = std::max(bounds.lower, witness_qi);
+#if QI_SAT_BACKEND
+    if (!bounds.certifies(min_required_qi) && !bounds.refutes(min_required_qi)) {
+        bounds = decideQiWithSat(kernel, min_required_qi, bounds, budget);
     }
+#endif
+    qi_bounds_ = bounds;
     
-    // Use recursive backtracking with early stopping
-    bool used[MAX_VERTICES] = {false};
-    int max_qi = 0;
-    
-    if (VERBOSE_QI_DEBUG) {
-        printf("Starting exhaustive search with early stopping (min_required: %d)...\n", min_required_qi);
+    // a certified threshold reports the proven lower bound; a refuted one reports
+    // the proven upper bound, which is already below the threshold
+    int qi = bounds.certifies(min_required_qi) ? bounds.lower : bounds.upper;
+    if (!bounds.certifies(min_required_qi) && !bounds.refutes(min_required_qi)) {
+        qi = -1; // budget ran out with the threshold still inside the interval
     }
     
-    findOptimalQi(block_labels, label_count, quotient_adj, used, 0, 0, max_qi, min_required_qi);
+    QI_TRACE(Qi, Info, "Branch and bound result: qi in [%d, %d], reporting %d (required >= %d)\n",
+                       bounds.lower, bounds.upper, qi, min_required_qi);
     
-    if (VERBOSE_QI_DEBUG) {
-        printf("Early stopping search result: qi = %d (required >= %d)\n", max_qi, min_required_qi);
-    }
-    
-    return max_qi;
+    return qi;
 }
 
-// Helper function for exact qi calculation using exhaustive backtracking
-void Partition::findOptimalQi(const int* block_labels, int label_count, 
-                             const bool quotient_adj[MAX_VERTICES][MAX_VERTICES],
-                             bool* used, int start_idx, int current_qi, int& max_qi) const {
-    
-    // Base case: no more unused blocks
-    bool has_unused = false;
-    for (int i = 0; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            has_unused = true;
-            break;
-        }
-    }
-    
-    if (!has_unused) {
-        if (current_qi > max_qi) {
-            max_qi = current_qi;
-        }
-        return;
-    }
-    
-    // Find first unused block
-    int first_unused = -1;
-    for (int i = 0; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            first_unused = i;
-            break;
-        }
-    }
-    
-    if (first_unused == -1) {
-        if (current_qi > max_qi) {
-            max_qi = current_qi;
-        }
-        return;
-    }
-    
-    int start_block = block_labels[first_unused];
-    
-    // Try all possible independent sets that include start_block
-    // Use bitmask to enumerate all subsets of remaining unused blocks
-    int unused_blocks[MAX_VERTICES];
-    int unused_count = 0;
-    
-    for (int i = first_unused + 1; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            unused_blocks[unused_count++] = block_labels[i];
-        }
-    }
-    
-    // Try all subsets of unused_blocks (2^unused_count possibilities)
-    int max_subset = 1 << unused_count;
-    
-    for (int subset = 0; subset < max_subset; subset++) {
-        // Build independent set starting with start_block
-        int independent_set[MAX_VERTICES];
-        int set_size = 1;
-        independent_set[0] = start_block;
-        
-        // Add blocks from subset if they form an independent set
-        bool valid_set = true;
-        for (int bit = 0; bit < unused_count && valid_set; bit++) {
-            if (subset & (1 << bit)) {
-                int candidate = unused_blocks[bit];
-                
-                // Check if candidate is independent of all blocks in current set
-                for (int j = 0; j < set_size; j++) {
-                    if (quotient_adj[candidate][independent_set[j]]) {
-                        valid_set = false;
-                        break;
-                    }
-                }
-                
-                if (valid_set) {
-                    independent_set[set_size++] = candidate;
-                }
-            }
-        }
-        
-        if (valid_set) {
-            if (VERBOSE_QI_DEBUG) {
-                // DEBUG: Print found independent set
-                printf("Found independent set (size %d, contributes %d): {", set_size, set_size - 1);
-                for (int j = 0; j < set_size; j++) {
-                    printf("%d", independent_set[j]);
-                    if (j < set_size - 1) printf(", ");
-                }
-                printf("}\n");
-            }
-            
-            // Mark blocks in this independent set as used
-            bool temp_used[MAX_VERTICES];
-            for (int j = 0; j < MAX_VERTICES; j++) {
-                temp_used[j] = used[j];
-            }
-            
-            for (int j = 0; j < set_size; j++) {
-                temp_used[independent_set[j]] = true;
-            }
-            
-            // Contribution is (set_size - 1), but ignore single blocks (contribute 0)
-            int contribution = (set_size > 1) ? set_size - 1 : 0;
-            
-            // Recursively solve for remaining blocks
-            findOptimalQi(block_labels, label_count, quotient_adj, temp_used, 
-                         0, current_qi + contribution, max_qi);
-        }
-    }
+// exact qi on the kernel, using the narrowest bitset that holds all its blocks, lifted
+// back to the quotient
+int Partition::calculateQiNumberExact(const QuotientKernel& kernel, int min_required_qi) const {
+    int kernel_colors[MAX_VERTICES];
+    int label_colors[MAX_VERTICES];
+    int kernel_required_qi = min_required_qi - kernel.getQiOffset();
+    int qi;
+    
+    if (kernel.getBlockCount() <= BlockSet<1>::CAPACITY) {
+        qi = solveExactQi<1>(kernel, kernel_required_qi, kernel_colors);
+    } else if (kernel.getBlockCount() <= BlockSet<2>::CAPACITY) {
+        qi = solveExactQi<2>(kernel, kernel_required_qi, kernel_colors);
+    } else {
+        qi = solveExactQi<4>(kernel, kernel_required_qi, kernel_colors);
+    }
+    kernel.liftColoring(kernel_colors, label_colors);
+    adoptWitness(label_colors);
+    return qi + kernel.getQiOffset();
 }
 
-// Helper function with early stopping for qi calculation
-void Partition::findOptimalQi(const int* block_labels, int label_count, 
-                             const bool quotient_adj[MAX_VERTICES][MAX_VERTICES],
-                             bool* used, int start_idx, int current_qi, int& max_qi,
-                             int min_required_qi) const {
-    
-    // Early stopping: if we've already found a sufficient qi, stop searching
-    if (max_qi >= min_required_qi) {
-        return;
-    }
-    
-    // Base case: no more unused blocks
-    bool has_unused = false;
-    for (int i = 0; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            has_unused = true;
-            break;
-        }
-    }
-    
-    if (!has_unused) {
-        if (current_qi > max_qi) {
-            max_qi = current_qi;
-        }
-        return;
-    }
-    
-    // Find first unused block
-    int first_unused = -1;
-    for (int i = 0; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            first_unused = i;
-            break;
-        }
-    }
-    
-    if (first_unused == -1) {
-        if (current_qi > max_qi) {
-            max_qi = current_qi;
-        }
-        return;
-    }
-    
-    int start_block = block_labels[first_unused];
-    
-    // Try all possible independent sets that include start_block
-    // Use bitmask to enumerate all subsets of remaining unused blocks
-    int unused_blocks[MAX_VERTICES];
-    int unused_count = 0;
-    
-    for (int i = first_unused + 1; i < label_count; i++) {
-        if (!used[block_labels[i]]) {
-            unused_blocks[unused_count++] = block_labels[i];
-        }
-    }
-    
-    // Try all subsets of unused_blocks (2^unused_count possibilities)
-    int max_subset = 1 << unused_count;
-    
-    for (int subset = 0; subset < max_subset; subset++) {
-        // Early stopping check
-        if (max_qi >= min_required_qi) {
-            return;
-        }
-        
-        // Build independent set starting with start_block
-        int independent_set[MAX_VERTICES];
-        int set_size = 1;
-        independent_set[0] = start_block;
-        
-        // Add blocks from subset if they form an independent set
-        bool valid_set = true;
-        for (int bit = 0; bit < unused_count && valid_set; bit++) {
-            if (subset & (1 << bit)) {
-                int candidate = unused_blocks[bit];
-                
-                // Check if candidate is independent of all blocks in current set
-                for (int j = 0; j < set_size; j++) {
-                    if (quotient_adj[candidate][independent_set[j]]) {
-                        valid_set = false;
-                        break;
-                    }
-                }
-                
-                if (valid_set) {
-                    independent_set[set_size++] = candidate;
-                }
-            }
-        }
-        
-        if (valid_set) {
-            // Mark blocks in this independent set as used
-            bool temp_used[MAX_VERTICES];
-            for (int j = 0; j < MAX_VERTICES; j++) {
-                temp_used[j] = used[j];
-            }
-            
-            for (int j = 0; j < set_size; j++) {
-                temp_used[independent_set[j]] = true;
-            }
-            
-            // Contribution is (set_size - 1)
-            int contribution = (set_size > 1) ? set_size - 1 : 0;
-            
-            // Recursively solve for remaining blocks
-            findOptimalQi(block_labels, label_count, quotient_adj, temp_used, 
-                         0, current_qi + contribution, max_qi, min_required_qi);
-        }
+// proven qi interval from the clique / DSATUR branch and bound on the kernel
+QiBounds Partition::calculateQiBounds(const QuotientKernel& kernel, int min_required_qi, SearchBudget* budget) const {
+    int kernel_colors[MAX_VERTICES];
+    int label_colors[MAX_VERTICES];
+    int kernel_required_qi = min_required_qi - kernel.getQiOffset();
+    QiBounds bounds;
+    
+    if (kernel.getBlockCount() > 1 && kernel_required_qi <= 0) {
+        // the offset alone meets the threshold: any proper coloring of the kernel
+        // certifies it, so take the DSATUR one as the witness instead of searching
+        int k = kernel.getBlockCount();
+        int colors = calculateDsaturColors(kernel) - kernel.getUniversalBlocks();
+        bounds = {k - colors, k - 1};
+        bounds.lower += kernel.getQiOffset();
+        bounds.upper += kernel.getQiOffset();
+        return bounds;
+    }
+    
+    if (kernel.getBlockCount() <= 1) {
+        // nothing left to search: one set (or none) covers the core
+        kernel_colors[0] = 0;
+        bounds = {0, 0};
+    } else if (kernel.getBlockCount() <= BlockSet<1>::CAPACITY) {
+        bounds = solveQiBounds<1>(kernel, kernel_required_qi, budget, search_threads_, kernel_colors);
+    } else if (kernel.getBlockCount() <= BlockSet<2>::CAPACITY) {
+        bounds = solveQiBounds<2>(kernel, kernel_required_qi, budget, search_threads_, kernel_colors);
+    } else {
+        bounds = solveQiBounds<4>(kernel, kernel_required_qi, budget, search_threads_, kernel_colors);
+    }
+    kernel.liftColoring(kernel_colors, label_colors);
+    adoptWitness(label_colors);
+    bounds.lower += kernel.getQiOffset();
+    bounds.upper += kernel.getQiOffset();
+    return bounds;
+}
+
+#if QI_SAT_BACKEND
+// the threshold as a SAT decision on the kernel, once the branch and bound left it inside
+// bounds: a coloring found becomes the witness cover, a refutation caps qi below it.
+// The solver gets its own conflict cap but keeps the step's deadline.
+QiBounds Partition::decideQiWithSat(const QuotientKernel& kernel, int min_required_qi, QiBounds bounds,
+                                    SearchBudget* budget) const {
+    int kernel_required_qi = min_required_qi - kernel.getQiOffset();
+    int colors = kernel.getBlockCount() - kernel_required_qi;
+    QiCounters& counters = QiCounters::local();
+    counters.sat_path++;
+    
+    QuotientGraph::Row kernel_adj[QuotientGraph::MAX_BLOCKS];
+    kernel.copyAdjacency(kernel_adj);
+    SatColoring coloring(kernel_adj, kernel.getBlockCount());
+    SearchBudget conflicts(SAT_MAX_CONFLICTS,
+                           budget ? budget->getDeadline() : SearchBudget::Clock::time_point::max());
+    SatSolver::Result result = coloring.decide(colors, &conflicts);
+    counters.sat_conflicts += coloring.getConflicts();
+    
+    if (result == SatSolver::Result::Sat) {
+        int kernel_colors[MAX_VERTICES];
+        int label_colors[MAX_VERTICES];
+        for (int i = 0; i < kernel.getBlockCount(); i++) kernel_colors[i] = coloring.getColor(i);
+        kernel.liftColoring(kernel_colors, label_colors);
+        adoptWitness(label_colors);
+        bounds.lower = std::max(bounds.lower, getWitnessQi());
+        bounds.exhausted = false;
+    } else if (result == SatSolver::Result::Unsat) {
+        bounds.upper = std::min(bounds.upper, min_required_qi - 1);
+        bounds.exhausted = false;
+    }
+    
+    const char* outcome = (result == SatSolver::Result::Sat) ? "colorable"
+                          : (result == SatSolver::Result::Unsat) ? "not colorable" : "undecided";
+    QI_TRACE(Qi, Info, "SAT backend: %s with %d colors after %lld conflicts -> qi in [%d, %d] (required >= %d)\n",
+             outcome, colors, coloring.getConflicts(), bounds.lower, bounds.upper, min_required_qi);
+    return bounds;
+}
+#endif
+
+// colors used by the in-tree DSATUR heuristic on the kernel, plus one per universal
+// block (upper bound on chi)
+int Partition::calculateDsaturColors(const QuotientKernel& kernel) const {
+    int kernel_colors[MAX_VERTICES];
+    int label_colors[MAX_VERTICES];
+    int colors;
+    
+    if (kernel.getBlockCount() <= BlockSet<1>::CAPACITY) {
+        colors = dsaturColors<1>(kernel, kernel_colors);
+    } else if (kernel.getBlockCount() <= BlockSet<2>::CAPACITY) {
+        colors = dsaturColors<2>(kernel, kernel_colors);
+    } else {
+        colors = dsaturColors<4>(kernel, kernel_colors);
+    }
+    kernel.liftColoring(kernel_colors, label_colors);
+    adoptWitness(label_colors);
+    return colors + kernel.getUniversalBlocks();
+}
+
+QiBounds Partition::estimateQiBounds(const Graph& graph) const {
+    const QuotientGraph& quotient = getQuotientGraph(graph);
+    if (num_blocks_ <= BlockSet<1>::CAPACITY) return estimateBounds<1>(quotient);
+    if (num_blocks_ <= BlockSet<2>::CAPACITY) return estimateBounds<2>(quotient);
+    return estimateBounds<4>(quotient);
+}
+
+bool Partition::getWitnessCover(int* label_colors) const {
+    if (!witness_valid_) return false;
+    for (int i = 0; i < num_blocks_; i++) {
+        label_colors[active_labels_[i]] = witness_color_[active_labels_[i]];
     }
+    return true;
 }
 
+// keep the solver's coloring as the witness cover unless the carried one is better
+void Partition::adoptWitness(const int* label_colors) const {
+    std::vector<int> sizes;
+    int colors = 0;
+    for (int i = 0; i < num_blocks_; i++) {
+        int color = label_colors[active_labels_[i]];
+        if (color >= static_cast<int>(sizes.size())) sizes.resize(color + 1, 0);
+        if (sizes[color]++ == 0) colors++;
+    }
+    if (witness_valid_ && witness_colors_ <= colors) return;
+    
+    witness_color_.assign(label_bound_, -1);
+    for (int i = 0; i < num_blocks_; i++) {
+        witness_color_[active_labels_[i]] = label_colors[active_labels_[i]];
+    }
+    color_size_.swap(sizes);
+    witness_colors_ = colors;
+    witness_valid_ = true;
+}
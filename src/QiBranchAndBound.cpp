@@ -0,0 +1,280 @@
+#include "../include/QiBranchAndBound.h"
+#include "../include/QiCounters.h"
+#include "../include/QuotientKernel.h"
+#include "../include/ThreadPool.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// the calling thread's search workers, kept across searches so that splitting one does
+// not start threads; rebuilt when the thread count changes
+ThreadPool& searchPool(int num_threads) {
+    thread_local std::unique_ptr<ThreadPool> pool;
+    if (!pool || pool->getNumThreads() != num_threads) pool = std::make_unique<ThreadPool>(num_threads);
+    return *pool;
+}
+
+} // namespace
+
+template <int Words>
+QiBranchAndBound<Words>::QiBranchAndBound(const Set* adjacency, int block_count, SearchBudget* budget)
+    : adjacency_(adjacency), block_count_(block_count), budget_(budget), num_threads_(1), root_(this),
+      clique_size_(0), dsatur_colors_(0), best_colors_(0), color_limit_(0), stop_colors_(0), cap_colors_(0),
+      nodes_(0), probe_nodes_(0), probe_cut_(false) {}
+
+template <int Words>
+void QiBranchAndBound<Words>::setThreads(int num_threads) {
+    num_threads_ = ThreadPool::resolveThreads(num_threads);
+}
+
+template <int Words>
+QiBounds QiBranchAndBound<Words>::solve() {
+    // search every coloring with fewer colors than the best one found
+    return run(0, block_count_ + 1);
+}
+
+template <int Words>
+QiBounds QiBranchAndBound<Words>::solve(int min_required_qi) {
+    // qi >= min_required_qi  <=>  chi <= k - min_required_qi
+    // (clamped to k, so a threshold at or below 0 still keeps the first dive's coloring)
+    int target_colors = std::clamp(block_count_ - min_required_qi, 0, block_count_);
+    return run(target_colors, target_colors + 1);
+}
+
+template <int Words>
+QiBounds QiBranchAndBound<Words>::run(int target_colors, int cap_colors) {
+    int k = block_count_;
+    if (k <= 1) {
+        // single block is q-complete, and one color (or none) covers it
+        clique_size_ = k;
+        dsatur_colors_ = k;
+        best_colors_ = k;
+        color_limit_ = k;
+        if (k == 1) best_color_[0] = 0;
+        return {0, 0};
+    }
+
+    clique_size_ = greedyClique();
+    dsatur_colors_ = 0;
+    best_colors_ = k + 1;
+    for (int b = 0; b < k; b++) best_color_[b] = b;
+    color_limit_ = k + 1; // the first dive (plain DSATUR) always completes
+    stop_colors_ = std::max(clique_size_, target_colors);
+    cap_colors_ = cap_colors;
+    nodes_ = 0;
+    probe_nodes_ = (num_threads_ > 1) ? PARALLEL_AFTER_NODES : 0;
+    probe_cut_ = false;
+    frontier_.clear();
+
+    colorRemaining(Set::firstN(k), 0);
+    if (probe_cut_) searchParallel();
+    QiCounters::local().search_nodes += nodes_;
+
+    QiBounds bounds;
+    bounds.lower = k - best_colors_;
+    if (best_colors_ <= stop_colors_) {
+        // stopped early: either optimal (meets the clique) or the threshold is certified
+        bounds.upper = k - clique_size_;
+    } else if (budget_ && budget_->isExhausted()) {
+        // cut short: the unexplored branches might still hold a better coloring
+        bounds.upper = k - clique_size_;
+        bounds.exhausted = true;
+    } else {
+        // searched to the end: no coloring with fewer than color_limit_ colors exists
+        bounds.upper = k - std::max(clique_size_, color_limit_.load());
+    }
+
+    QI_TRACE(Search, Debug, "Branch and bound: clique=%d dsatur=%d best=%d -> qi in [%d, %d]%s\n",
+             clique_size_, dsatur_colors_, best_colors_.load(), bounds.lower, bounds.upper,
+             bounds.exhausted ? " (budget exhausted)" : "");
+    return bounds;
+}
+
+// greedy clique from every start block; its size is a lower bound on chi
+template <int Words>
+int QiBranchAndBound<Words>::greedyClique() const {
+    return std::max(1, QuotientKernel::greedyClique(adjacency_, block_count_).count());
+}
+
+// DSATUR order: most distinct neighbour colors, ties broken by uncolored degree
+template <int Words>
+int QiBranchAndBound<Words>::selectBlock(const Set& uncolored, int colors_used) const {
+    int best = -1;
+    int best_saturation = -1;
+    int best_degree = -1;
+    Set pool = uncolored;
+    for (int b = pool.popLowest(); b >= 0; b = pool.popLowest()) {
+        int saturation = 0;
+        for (int c = 0; c < colors_used; c++) {
+            if (color_members_[c].intersects(adjacency_[b])) saturation++;
+        }
+        if (saturation < best_saturation) continue;
+        int degree = (adjacency_[b] & uncolored).count();
+        if (saturation > best_saturation || degree > best_degree) {
+            best = b;
+            best_saturation = saturation;
+            best_degree = degree;
+        }
+    }
+    return best;
+}
+
+template <int Words>
+void QiBranchAndBound<Words>::colorRemaining(Set uncolored, int colors_used) {
+    // done once the threshold is met or no coloring can beat the clique bound
+    // (a subtree handed to a worker may already be beaten by another thread's coloring)
+    int color_limit = colorLimit();
+    if (bestColors() <= stop_colors_ || color_limit <= clique_size_ || colors_used >= color_limit) return;
+    nodes_++;
+
+    // the first dive always completes, so a DSATUR bound exists however small the budget
+    if (budget_ && bestColors() <= block_count_ && budget_->charge()) return;
+    if (probe_nodes_ > 0 && nodes_ >= probe_nodes_ && bestColors() <= block_count_) {
+        probe_cut_ = true;
+        frontier_.push_back({std::vector<Set>(color_members_, color_members_ + colors_used), uncolored});
+        return;
+    }
+
+    if (uncolored.empty()) {
+        recordColoring(colors_used);
+        return;
+    }
+
+    int block = selectBlock(uncolored, colors_used);
+    uncolored.reset(block);
+
+    // reuse an existing color the block does not conflict with
+    for (int c = 0; c < colors_used; c++) {
+        if (color_members_[c].intersects(adjacency_[block])) continue;
+        color_members_[c].set(block);
+        colorRemaining(uncolored, colors_used);
+        color_members_[c].reset(block);
+        if (bestColors() <= stop_colors_ || colors_used >= colorLimit()) return;
+        if (stopped()) {
+            if (probe_cut_) saveFrontier(block, uncolored, colors_used, c + 1);
+            return;
+        }
+    }
+
+    // open a new color only while it can still beat the limit
+    if (colors_used + 1 < colorLimit()) {
+        color_members_[colors_used] = Set::none();
+        color_members_[colors_used].set(block);
+        colorRemaining(uncolored, colors_used + 1);
+    }
+}
+
+// a complete coloring with fewer colors than any before it becomes the best one
+template <int Words>
+void QiBranchAndBound<Words>::recordColoring(int colors_used) {
+    QiBranchAndBound& root = *root_;
+    std::lock_guard<std::mutex> lock(root.best_mutex_);
+    if (colors_used >= root.best_colors_) return;   // another thread got there first
+    if (root.dsatur_colors_ == 0) root.dsatur_colors_ = colors_used;
+    for (int c = 0; c < colors_used; c++) {
+        Set members = color_members_[c];
+        for (int b = members.popLowest(); b >= 0; b = members.popLowest()) {
+            root.best_color_[b] = c;
+        }
+    }
+    root.best_colors_ = colors_used;
+    root.color_limit_ = std::min(colors_used, cap_colors_);
+}
+
+// the choices for block the probe had not tried yet when it was cut, from color
+// first_color on; frames unwind deepest first, so the frontier stays in search order
+template <int Words>
+void QiBranchAndBound<Words>::saveFrontier(int block, const Set& uncolored, int colors_used, int first_color) {
+    std::vector<Set> members(color_members_, color_members_ + colors_used);
+    for (int c = first_color; c < colors_used; c++) {
+        if (members[c].intersects(adjacency_[block])) continue;
+        frontier_.push_back({members, uncolored});
+        frontier_.back().members[c].set(block);
+    }
+    if (colors_used + 1 < colorLimit()) {
+        frontier_.push_back({members, uncolored});
+        frontier_.back().members.push_back(Set::none());
+        frontier_.back().members.back().set(block);
+    }
+}
+
+// continue the search from where the probe was cut, as subtrees shared out between
+// threads: everything left of the probe's path is done, and its best coloring and
+// limit already prune the rest
+template <int Words>
+void QiBranchAndBound<Words>::searchParallel() {
+    probe_nodes_ = 0;
+    probe_cut_ = false;
+
+    // expand level by level, children in search order, until every thread has plenty
+    // of subtrees to pick from; threads take them in order, so the first subtrees (the
+    // ones the serial search would visit first) are searched first
+    std::vector<Task> tasks;
+    tasks.swap(frontier_);
+    size_t wanted = static_cast<size_t>(num_threads_) * TASKS_PER_THREAD;
+    bool expanded = true;
+    while (expanded && tasks.size() < wanted) {
+        expanded = false;
+        std::vector<Task> next;
+        for (const Task& task : tasks) {
+            int colors_used = static_cast<int>(task.members.size());
+            if (task.uncolored.empty() || colors_used >= colorLimit()) {
+                next.push_back(task);
+                continue;
+            }
+            expanded = true;
+            std::copy(task.members.begin(), task.members.end(), color_members_);
+            int block = selectBlock(task.uncolored, colors_used);
+            for (int c = 0; c < colors_used; c++) {
+                if (color_members_[c].intersects(adjacency_[block])) continue;
+                next.push_back(task);
+                next.back().members[c].set(block);
+                next.back().uncolored.reset(block);
+            }
+            if (colors_used + 1 < colorLimit()) {
+                next.push_back(task);
+                next.back().members.push_back(Set::none());
+                next.back().members.back().set(block);
+                next.back().uncolored.reset(block);
+            }
+        }
+        tasks.swap(next);
+    }
+
+    // one solver per thread, each with its share of what is left of the budget
+    ThreadPool& pool = searchPool(num_threads_);
+    int workers = pool.getNumThreads();
+    std::vector<SearchBudget> budgets(workers);
+    std::vector<std::unique_ptr<QiBranchAndBound>> solvers;
+    for (int worker = 0; worker < workers; worker++) {
+        if (budget_) budgets[worker] = budget_->share(workers);
+        solvers.emplace_back(new QiBranchAndBound(adjacency_, block_count_, budget_ ? &budgets[worker] : nullptr));
+        QiBranchAndBound& solver = *solvers.back();
+        solver.root_ = this;
+        solver.clique_size_ = clique_size_;
+        solver.stop_colors_ = stop_colors_;
+        solver.cap_colors_ = cap_colors_;
+    }
+
+    QI_TRACE(Search, Debug, "Branch and bound: split into %zu subtrees on %d threads (best=%d)\n",
+             tasks.size(), workers, bestColors());
+
+    pool.parallelFor(static_cast<int>(tasks.size()), [&](int index, int worker) {
+        QiBranchAndBound& solver = *solvers[worker];
+        if (solver.stopped()) return;   // its share of the budget is spent
+        const Task& task = tasks[index];
+        std::copy(task.members.begin(), task.members.end(), solver.color_members_);
+        solver.colorRemaining(task.uncolored, static_cast<int>(task.members.size()));
+    });
+
+    for (int worker = 0; worker < workers; worker++) {
+        nodes_ += solvers[worker]->nodes_;
+        if (budget_) budget_->settle(budgets[worker]);
+    }
+}
+
+template class QiBranchAndBound<1>;
+template class QiBranchAndBound<2>;
+template class QiBranchAndBound<4>;
@@ -0,0 +1,256 @@
+#include "../include/QiCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+// orderings tried per key when fully canonicalizing
+const int PERMUTATION_LIMIT = 24;
+
+const char CACHE_MAGIC[4] = {'Q', 'I', 'C', '1'};
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    return x ^ (x >> 33);
+}
+
+int countDistinct(const uint64_t* values, int count) {
+    uint64_t sorted[QiCache::MAX_BLOCKS];
+    std::copy(values, values + count, sorted);
+    std::sort(sorted, sorted + count);
+    return static_cast<int>(std::unique(sorted, sorted + count) - sorted);
+}
+
+// largest key: the count byte plus the upper triangle of MAX_BLOCKS blocks
+const int MAX_KEY_BYTES = 1 + (QiCache::MAX_BLOCKS * (QiCache::MAX_BLOCKS - 1) / 2 + 7) / 8;
+
+// block count, then the upper triangle of the adjacency in the given order; returns
+// the key length
+int encode(const BlockSet<1>* adjacency, const int* order, int count, unsigned char* key) {
+    int length = 1 + (count * (count - 1) / 2 + 7) / 8;
+    std::fill(key, key + length, 0);
+    key[0] = static_cast<unsigned char>(count);
+    int bit = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++, bit++) {
+            if (adjacency[order[i]].test(order[j])) key[1 + (bit >> 3)] |= static_cast<unsigned char>(1 << (bit & 7));
+        }
+    }
+    return length;
+}
+
+// whether a key read back from a file is well formed and entry is a sound interval for
+// the adjacency it encodes: a proper coloring with colors below the block count, using
+// no more than k - lower of them, and lower <= upper <= k - 1
+bool isValidEntry(const std::string& key, const QiCache::Entry& entry) {
+    int count = static_cast<unsigned char>(key[0]);
+    if (count < 1 || count > QiCache::MAX_BLOCKS) return false;
+    if (key.size() != static_cast<size_t>(1 + (count * (count - 1) / 2 + 7) / 8)) return false;
+    if (static_cast<int>(entry.colors.size()) != count) return false;
+    if (entry.bounds.lower < 0 || entry.bounds.lower > entry.bounds.upper || entry.bounds.upper > count - 1) {
+        return false;
+    }
+
+    BlockSet<1> used = BlockSet<1>::none();
+    for (int i = 0; i < count; i++) {
+        if (entry.colors[i] >= count) return false;
+        used.set(entry.colors[i]);
+    }
+    if (used.count() > count - entry.bounds.lower) return false;
+
+    int bit = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++, bit++) {
+            bool adjacent = (static_cast<unsigned char>(key[1 + (bit >> 3)]) >> (bit & 7)) & 1;
+            if (adjacent && entry.colors[i] == entry.colors[j]) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+QiCache& QiCache::global() {
+    static QiCache cache;
+    return cache;
+}
+
+std::string QiCache::canonicalKey(const QuotientGraph& quotient, int* order) {
+    BlockSet<1> adjacency[MAX_BLOCKS];
+    int block_labels[QuotientGraph::MAX_BLOCKS];
+    int count = quotient.compact(adjacency, block_labels);
+
+    // colour refinement: a block's colour hashes its own and its neighbours' colours,
+    // until the number of classes stops growing; colours depend only on structure
+    uint64_t colour[MAX_BLOCKS];
+    uint64_t mixed[MAX_BLOCKS];
+    for (int i = 0; i < count; i++) colour[i] = mix(adjacency[i].count());
+    int classes = countDistinct(colour, count);
+    while (classes < count) {
+        for (int i = 0; i < count; i++) mixed[i] = mix(colour[i]);
+        for (int i = 0; i < count; i++) {
+            uint64_t neighbours = 0;
+            BlockSet<1> row = adjacency[i];
+            for (int b = row.popLowest(); b >= 0; b = row.popLowest()) neighbours += mixed[b];
+            colour[i] = mix(colour[i] * 0x9e3779b97f4a7c15ULL ^ neighbours);
+        }
+        int refined = countDistinct(colour, count);
+        if (refined == classes) break;
+        classes = refined;
+    }
+
+    int positions[MAX_BLOCKS];
+    for (int i = 0; i < count; i++) positions[i] = i;
+    std::sort(positions, positions + count, [&](int a, int b) {
+        return colour[a] != colour[b] ? colour[a] < colour[b] : a < b;
+    });
+
+    // small quotients: try every order of the tied blocks and keep the least key
+    unsigned char key[MAX_KEY_BYTES];
+    int length = encode(adjacency, positions, count, key);
+    if (count <= CANONICAL_BLOCKS && classes < count) {
+        std::vector<std::pair<int, int>> cells;     // [start, end) runs of one colour
+        long long orderings = 1;
+        for (int start = 0; start < count;) {
+            int end = start + 1;
+            while (end < count && colour[positions[end]] == colour[positions[start]]) end++;
+            for (int size = 2; size <= end - start && orderings <= PERMUTATION_LIMIT; size++) orderings *= size;
+            if (end - start > 1) cells.push_back({start, end});
+            start = end;
+        }
+        if (orderings <= PERMUTATION_LIMIT) {
+            int best[MAX_BLOCKS];
+            std::copy(positions, positions + count, best);
+            // odometer over the cells: advance the first cell that has a next permutation
+            while (true) {
+                size_t cell = 0;
+                while (cell < cells.size() &&
+                       !std::next_permutation(positions + cells[cell].first, positions + cells[cell].second)) {
+                    cell++;     // wrapped back to sorted order; carry into the next cell
+                }
+                if (cell == cells.size()) break;
+                unsigned char candidate[MAX_KEY_BYTES];
+                encode(adjacency, positions, count, candidate);
+                if (std::memcmp(candidate, key, length) < 0) {
+                    std::copy(candidate, candidate + length, key);
+                    std::copy(positions, positions + count, best);
+                }
+            }
+            std::copy(best, best + count, positions);
+        }
+    }
+
+    for (int i = 0; i < count; i++) order[i] = block_labels[positions[i]];
+    return std::string(reinterpret_cast<const char*>(key), length);
+}
+
+bool QiCache::lookup(const std::string& key, Entry& entry) const {
+    const Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return false;
+    entry = it->second;
+    return true;
+}
+
+void QiCache::store(const std::string& key, const Entry& entry) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        if (shard.entries.size() < MAX_ENTRIES_PER_SHARD) {
+            Entry& stored = shard.entries[key];
+            stored = entry;
+            stored.bounds.exhausted = false;
+        }
+        return;
+    }
+    Entry& known = it->second;
+    if (entry.bounds.lower > known.bounds.lower) {
+        known.bounds.lower = entry.bounds.lower;
+        known.colors = entry.colors;
+    }
+    known.bounds.upper = std::min(known.bounds.upper, entry.bounds.upper);
+}
+
+size_t QiCache::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+// magic, entry count, then per entry: key length (uint16), key, lower and upper
+// (int16 each), one color byte per block. Entries are checked against their key
+// before use, so a stale or edited file cannot certify a step.
+bool QiCache::load(const std::string& path, std::string& error, size_t& dropped) {
+    dropped = 0;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return true;   // first run: nothing cached yet
+
+    char magic[4];
+    uint64_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+        error = "Not a qi cache file: " + path;
+        return false;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        uint16_t key_length;
+        int16_t bounds[2];
+        file.read(reinterpret_cast<char*>(&key_length), sizeof(key_length));
+        std::string key(key_length, '\0');
+        file.read(key.data(), key_length);
+        file.read(reinterpret_cast<char*>(bounds), sizeof(bounds));
+        if (!file || key.empty()) break;
+        Entry entry;
+        entry.bounds = {bounds[0], bounds[1]};
+        entry.colors.resize(static_cast<unsigned char>(key[0]));
+        file.read(reinterpret_cast<char*>(entry.colors.data()), entry.colors.size());
+        if (!file) break;
+        if (isValidEntry(key, entry)) {
+            store(key, entry);
+        } else {
+            dropped++;
+        }
+    }
+    if (!file) {
+        error = "Truncated qi cache file: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool QiCache::save(const std::string& path, std::string& error) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Could not write to qi cache file " + path;
+        return false;
+    }
+    uint64_t count = size();
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [key, entry] : shard.entries) {
+            uint16_t key_length = static_cast<uint16_t>(key.size());
+            int16_t bounds[2] = {static_cast<int16_t>(entry.bounds.lower), static_cast<int16_t>(entry.bounds.upper)};
+            file.write(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+            file.write(key.data(), key.size());
+            file.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+            file.write(reinterpret_cast<const char*>(entry.colors.data()), entry.colors.size());
+        }
+    }
+    if (!file) {
+        error = "Could not write to qi cache file " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+#include "../include/QiCounters.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+long long peakMemoryKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS info;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) return 0;
+    return static_cast<long long>(info.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;        // kilobytes on Linux
+#endif
+#endif
+}
@@ -0,0 +1,239 @@
+#include "../include/QuotientGraph.h"
+#include "../include/Graph.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define QI_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define QI_X86_KERNELS 0
+#endif
+
+namespace {
+
+// the blocks whose members intersect reached, out of blocks, portably
+void testBlocksPortable(const QuotientGraph::VertexMask& reached, const QuotientGraph::VertexMask* members,
+                        const QuotientGraph::Row& blocks, QuotientGraph::Row& row) {
+    for (int w = 0; w < 4; w++) {
+        uint64_t hits = 0;
+        for (uint64_t rest = blocks.words[w]; rest; rest &= rest - 1) {
+            int bit = std::countr_zero(rest);
+            const uint64_t* block_members = members[(w << 6) + bit].words;
+            uint64_t hit = (reached.words[0] & block_members[0]) | (reached.words[1] & block_members[1]) |
+                           (reached.words[2] & block_members[2]) | (reached.words[3] & block_members[3]);
+            hits |= uint64_t(hit != 0) << bit;
+        }
+        row.words[w] |= hits;
+    }
+}
+
+#if QI_X86_KERNELS
+// a 256-bit mask is one AVX2 register: one vptest per block
+__attribute__((target("avx2")))
+void testBlocksAvx2(const QuotientGraph::VertexMask& reached, const QuotientGraph::VertexMask* members,
+                    const QuotientGraph::Row& blocks, QuotientGraph::Row& row) {
+    __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(reached.words));
+    for (int w = 0; w < 4; w++) {
+        uint64_t hits = 0;
+        for (uint64_t rest = blocks.words[w]; rest; rest &= rest - 1) {
+            int bit = std::countr_zero(rest);
+            __m256i block_members = _mm256_load_si256(reinterpret_cast<const __m256i*>(members[(w << 6) + bit].words));
+            hits |= uint64_t(!_mm256_testz_si256(mask, block_members)) << bit;
+        }
+        row.words[w] |= hits;
+    }
+}
+
+// two blocks per 512-bit test, their lanes read back from the 8-bit result
+__attribute__((target("avx512f")))
+void testBlocksAvx512(const QuotientGraph::VertexMask& reached, const QuotientGraph::VertexMask* members,
+                      const QuotientGraph::Row& blocks, QuotientGraph::Row& row) {
+    __m256i half = _mm256_load_si256(reinterpret_cast<const __m256i*>(reached.words));
+    // all-lanes maskz forms throughout: GCC 12's unmasked broadcast and insert (and the
+    // zero extension built on them) pass an undefined vector through and trip
+    // -Wuninitialized. The pair starts as the first block's broadcast, so every lane is
+    // defined before its upper half is replaced.
+    __m512i mask = _mm512_maskz_broadcast_i64x4(0xff, half);
+    for (int w = 0; w < 4; w++) {
+        uint64_t hits = 0;
+        uint64_t rest = blocks.words[w];
+        while (rest) {
+            int first = std::countr_zero(rest);
+            rest &= rest - 1;
+            int second = rest ? std::countr_zero(rest) : first;
+            rest &= rest - (rest != 0);
+            __m512i pair = _mm512_maskz_inserti64x4(0xff,
+                _mm512_maskz_broadcast_i64x4(0xff, _mm256_load_si256(reinterpret_cast<const __m256i*>(members[(w << 6) + first].words))),
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(members[(w << 6) + second].words)), 1);
+            unsigned lanes = _mm512_test_epi64_mask(mask, pair);
+            hits |= (uint64_t((lanes & 0x0f) != 0) << first) | (uint64_t((lanes & 0xf0) != 0) << second);
+        }
+        row.words[w] |= hits;
+    }
+}
+#endif
+
+} // namespace
+
+// kernel for this CPU: avx2 when supported, or QI_SIMD=portable|avx2|avx512
+const QuotientGraph::Kernel& QuotientGraph::selectKernel() {
+    static const Kernel kernel = [] {
+        // avx512 only on request: packing two blocks per test costs more than it saves
+        std::string cap = std::getenv("QI_SIMD") ? std::getenv("QI_SIMD") : "avx2";
+#if QI_X86_KERNELS
+        if (cap == "avx512" && __builtin_cpu_supports("avx512f")) return Kernel{"avx512", testBlocksAvx512, 2};
+        if (cap != "portable" && __builtin_cpu_supports("avx2")) return Kernel{"avx2", testBlocksAvx2, 2};
+#endif
+        return Kernel{"portable", testBlocksPortable, 1};
+    }();
+    return kernel;
+}
+
+QuotientGraph::QuotientGraph() : built_(false) {
+    blocks_ = Row::none();
+}
+
+QuotientGraph::QuotientGraph(const QuotientGraph& other) {
+    copyFrom(other);
+}
+
+QuotientGraph& QuotientGraph::operator=(const QuotientGraph& other) {
+    if (this != &other) {
+        copyFrom(other);
+    }
+    return *this;
+}
+
+void QuotientGraph::copyFrom(const QuotientGraph& other) {
+    blocks_ = other.blocks_;
+    built_ = other.built_;
+    rows_.resize(other.rows_.size());
+    Row remaining = blocks_;
+    for (int label = remaining.popLowest(); label >= 0; label = remaining.popLowest()) {
+        rows_[label] = other.rows_[label];
+    }
+}
+
+void QuotientGraph::clear() {
+    Row remaining = blocks_;
+    for (int label = remaining.popLowest(); label >= 0; label = remaining.popLowest()) {
+        rows_[label] = Row::none();
+    }
+    blocks_ = Row::none();
+    built_ = false;
+}
+
+void QuotientGraph::build(const Graph& graph, const int* partition, int num_vertices) {
+    clear();
+
+    int label_bound = 0;
+    int labels[MAX_BLOCKS];
+    int count = 0;
+    for (int v = 0; v < num_vertices; v++) {
+        assert(partition[v] >= 0 && partition[v] < MAX_BLOCKS);
+        if (!blocks_.test(partition[v])) labels[count++] = partition[v];
+        blocks_.set(partition[v]);
+        label_bound = std::max(label_bound, partition[v] + 1);
+    }
+    rows_.assign(label_bound, Row::none());
+
+    // near-singleton blocks gain nothing from pooling their rows: every edge is one
+    // row bit either way, so walk each edge once via CSR
+    if (count * 2 > num_vertices) {
+        for (int u = 0; u < num_vertices; u++) {
+            const int* neighbours = graph.getNeighbours(u);
+            int degree = graph.getDegree(u);
+            int block_u = partition[u];
+            for (int i = 0; i < degree; i++) {
+                int v = neighbours[i];
+                if (v <= u) continue;
+                int block_v = partition[v];
+                if (block_u != block_v) {
+                    rows_[block_u].set(block_v);
+                    rows_[block_v].set(block_u);
+                }
+            }
+        }
+        built_ = true;
+        return;
+    }
+
+    // per block: the vertices it reaches (its members' adjacency rows OR-ed together) and
+    // its members, both padded to full vector width
+    alignas(64) VertexMask reach[MAX_BLOCKS];
+    alignas(64) VertexMask members[MAX_BLOCKS];
+    for (int i = 0; i < count; i++) {
+        reach[labels[i]] = VertexMask{};
+        members[labels[i]] = VertexMask{};
+    }
+    int row_words = graph.getRowWords();
+    for (int v = 0; v < num_vertices; v++) {
+        const uint64_t* row = graph.getAdjacencyRow(v);
+        uint64_t* target = reach[partition[v]].words;
+        for (int w = 0; w < row_words; w++) target[w] |= row[w];
+        members[partition[v]].words[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+
+    // a reached vertex names its block directly, so sparse rows are cheapest scattered
+    // bit by bit; dense ones test every block's members at once
+    const Kernel& kernel = selectKernel();
+    for (int i = 0; i < count; i++) {
+        int block = labels[i];
+        const VertexMask& reached = reach[block];
+        int reached_count = 0;
+        for (int w = 0; w < row_words; w++) reached_count += std::popcount(reached.words[w]);
+
+        Row& row = rows_[block];
+        if (reached_count * kernel.scatter_weight <= count) {
+            for (int w = 0; w < row_words; w++) {
+                for (uint64_t bits = reached.words[w]; bits; bits &= bits - 1) {
+                    row.set(partition[(w << 6) + std::countr_zero(bits)]);
+                }
+            }
+        } else {
+            kernel.test(reached, members, blocks_, row);
+        }
+        row.reset(block);
+    }
+    built_ = true;
+}
+
+void QuotientGraph::mergeBlocks(int block1, int block2) {
+    if (block1 == block2) return;
+
+    // repoint every neighbour of block2 at block1
+    Row neighbours = rows_[block2];
+    for (int label = neighbours.popLowest(); label >= 0; label = neighbours.popLowest()) {
+        rows_[label].reset(block2);
+        if (label != block1) {
+            rows_[label].set(block1);
+        }
+    }
+
+    rows_[block1] |= rows_[block2];
+    rows_[block1].reset(block1);
+    rows_[block1].reset(block2);
+    rows_[block2] = Row::none();
+    blocks_.reset(block2);
+}
+
+void QuotientGraph::unmergeBlocks(int block1, int block2, const Row& block1_row, const Row& block2_row) {
+    // neighbours block1 only gained through block2 lose it again
+    Row gained = rows_[block1].without(block1_row);
+    for (int label = gained.popLowest(); label >= 0; label = gained.popLowest()) {
+        rows_[label].reset(block1);
+    }
+
+    Row neighbours = block2_row;
+    for (int label = neighbours.popLowest(); label >= 0; label = neighbours.popLowest()) {
+        rows_[label].set(block2);
+    }
+
+    rows_[block1] = block1_row;
+    rows_[block2] = block2_row;
+    blocks_.set(block2);
+}
@@ -0,0 +1,89 @@
+#include "../include/QuotientKernel.h"
+
+QuotientKernel::QuotientKernel(const QuotientGraph& quotient)
+    : kernel_count_(0), removed_count_(0), universal_count_(0) {
+    block_count_ = quotient.compact(adjacency_, block_labels_);
+    alive_ = Row::firstN(block_count_);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        Row clique = greedyClique();
+        Row pool = alive_;
+        for (int u = pool.popLowest(); u >= 0; u = pool.popLowest()) {
+            Row others = alive_;
+            others.reset(u);
+            Row neighbours = adjacency_[u] & alive_;
+            if (neighbours == others) {
+                remove(u, Rule::Universal, -1);
+                changed = true;
+                continue;
+            }
+
+            // a non-neighbour adjacent to all of u's neighbours can lend u its color
+            Row strangers = others.without(neighbours);
+            int partner = -1;
+            for (int v = strangers.popLowest(); v >= 0 && partner < 0; v = strangers.popLowest()) {
+                if (neighbours.without(adjacency_[v]).empty()) partner = v;
+            }
+            if (partner >= 0) {
+                remove(u, Rule::Dominated, partner);
+                changed = true;
+                continue;
+            }
+
+            // the clique must still be whole for its size to bound the colors of the rest
+            Row core = clique & alive_;
+            if (!core.test(u) && neighbours.count() < core.count()) {
+                remove(u, Rule::LowDegree, -1);
+                changed = true;
+            }
+        }
+    }
+
+    Row kernel = alive_;
+    for (int b = kernel.popLowest(); b >= 0; b = kernel.popLowest()) kernel_blocks_[kernel_count_++] = b;
+}
+
+// greedy clique of the live blocks, grown by the candidate that keeps most candidates
+QuotientKernel::Row QuotientKernel::greedyClique() const {
+    return growClique(adjacency_, Row::none(), alive_);
+}
+
+void QuotientKernel::remove(int block, Rule rule, int partner) {
+    alive_.reset(block);
+    removed_[removed_count_] = block;
+    rule_[removed_count_] = rule;
+    partner_[removed_count_] = partner;
+    removed_count_++;
+    if (rule == Rule::Universal) universal_count_++;
+}
+
+void QuotientKernel::liftColoring(const int* kernel_colors, int* label_colors) const {
+    int colors[QuotientGraph::MAX_BLOCKS];
+    int colors_used = 0;
+    Row present = alive_;
+    for (int i = 0; i < kernel_count_; i++) {
+        colors[kernel_blocks_[i]] = kernel_colors[i];
+        if (kernel_colors[i] >= colors_used) colors_used = kernel_colors[i] + 1;
+    }
+
+    for (int r = removed_count_ - 1; r >= 0; r--) {
+        int block = removed_[r];
+        if (rule_[r] == Rule::Universal) {
+            colors[block] = colors_used++;
+        } else if (rule_[r] == Rule::Dominated) {
+            colors[block] = colors[partner_[r]];
+        } else {
+            // lowest color no present neighbour has; one exists by the clique bound
+            Row taken = Row::none();
+            Row neighbours = adjacency_[block] & present;
+            for (int b = neighbours.popLowest(); b >= 0; b = neighbours.popLowest()) taken.set(colors[b]);
+            int color = Row::firstN(colors_used).without(taken).lowest();
+            colors[block] = (color >= 0) ? color : colors_used++;
+        }
+        present.set(block);
+    }
+
+    for (int b = 0; b < block_count_; b++) label_colors[block_labels_[b]] = colors[b];
+}
@@ -0,0 +1,77 @@
+#include "../include/SatColoring.h"
+#include "../include/QuotientKernel.h"
+#include <algorithm>
+#include <vector>
+
+SatColoring::SatColoring(const Row* adjacency, int block_count)
+    : adjacency_(adjacency), block_count_(block_count), conflicts_(0) {
+    for (int b = 0; b < block_count_; b++) color_[b] = b;
+}
+
+int SatColoring::orderBlocks(int* order) const {
+    // largest greedy clique over all start blocks
+    Row best = QuotientKernel::greedyClique(adjacency_, block_count_);
+
+    int count = 0;
+    Row members = best;
+    for (int b = members.popLowest(); b >= 0; b = members.popLowest()) order[count++] = b;
+    int clique_size = count;
+    for (int b = 0; b < block_count_; b++) {
+        if (!best.test(b)) order[count++] = b;
+    }
+    std::stable_sort(order + clique_size, order + count, [&](int a, int b) {
+        return adjacency_[a].count() > adjacency_[b].count();
+    });
+    return clique_size;
+}
+
+SatSolver::Result SatColoring::decide(int colors, SearchBudget* budget) {
+    int order[QuotientGraph::MAX_BLOCKS];
+    int clique_size = orderBlocks(order);
+    if (clique_size > colors) return SatSolver::Result::Unsat;
+
+    // variables only for the colors a block may take: 0 marks a forbidden one
+    SatSolver solver;
+    std::vector<int> variable(static_cast<size_t>(block_count_) * colors, 0);
+    for (int p = 0; p < block_count_; p++) {
+        int block = order[p];
+        int first = (p < clique_size) ? p : 0;
+        int last = std::min(colors - 1, p);
+        for (int c = first; c <= last; c++) variable[block * colors + c] = solver.newVariable();
+    }
+
+    std::vector<int> clause;
+    for (int block = 0; block < block_count_; block++) {
+        clause.clear();
+        for (int c = 0; c < colors; c++) {
+            if (variable[block * colors + c]) clause.push_back(variable[block * colors + c]);
+        }
+        solver.addClause(clause);
+
+        Row neighbours = adjacency_[block] & Row::firstN(block_count_);
+        for (int other = neighbours.popLowest(); other >= 0; other = neighbours.popLowest()) {
+            if (other < block) continue;
+            for (int c = 0; c < colors; c++) {
+                int x = variable[block * colors + c];
+                int y = variable[other * colors + c];
+                if (x && y) solver.addClause({-x, -y});
+            }
+        }
+    }
+
+    SatSolver::Result result = solver.solve(budget);
+    conflicts_ = solver.getConflicts();
+    if (result != SatSolver::Result::Sat) return result;
+
+    // any true color of a block is proper, so take the lowest
+    for (int block = 0; block < block_count_; block++) {
+        for (int c = 0; c < colors; c++) {
+            int x = variable[block * colors + c];
+            if (x && solver.modelValue(x)) {
+                color_[block] = c;
+                break;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,373 @@
+#include "../include/SatSolver.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// i-th term (from 0) of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+long long luby(int i) {
+    long long size = 1;
+    int seq = 0;
+    while (size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    long long x = i;
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return 1LL << seq;
+}
+
+int toLiteral(int dimacs) {
+    return 2 * (std::abs(dimacs) - 1) + (dimacs < 0 ? 1 : 0);
+}
+
+} // namespace
+
+SatSolver::SatSolver()
+    : ok_(true), qhead_(0), var_inc_(1.0), level_stamp_(1, 0), stamp_(0), conflicts_(0), learnts_(0),
+      max_learnts_(MIN_LEARNTS), restarts_(0) {}
+
+int SatSolver::newVariable() {
+    int variable = getNumVariables();
+    assigns_.push_back(VALUE_UNDEF);
+    level_.push_back(0);
+    reason_.push_back(-1);
+    activity_.push_back(0.0);
+    polarity_.push_back(1);
+    seen_.push_back(0);
+    level_stamp_.push_back(0);
+    heap_index_.push_back(-1);
+    watches_.emplace_back();
+    watches_.emplace_back();
+    heapInsert(variable);
+    return variable + 1;
+}
+
+bool SatSolver::addClause(const std::vector<int>& literals) {
+    if (!ok_) return false;
+
+    // drop duplicates and level-0 false literals; tautologies and satisfied clauses vanish
+    std::vector<int> clause;
+    for (int dimacs : literals) clause.push_back(toLiteral(dimacs));
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < clause.size(); i++) {
+        int literal = clause[i];
+        if (value(literal) == VALUE_TRUE || (i + 1 < clause.size() && clause[i + 1] == (literal ^ 1))) return true;
+        if (value(literal) != VALUE_FALSE) clause[kept++] = literal;
+    }
+    clause.resize(kept);
+
+    if (clause.empty()) {
+        ok_ = false;
+    } else if (clause.size() == 1) {
+        enqueue(clause[0], -1);
+        ok_ = (propagate() < 0);
+    } else {
+        clauses_.push_back({clause, false, 0});
+        attach(static_cast<int>(clauses_.size()) - 1);
+    }
+    return ok_;
+}
+
+void SatSolver::attach(int clause) {
+    const std::vector<int>& literals = clauses_[clause].literals;
+    bool binary = (literals.size() == 2);
+    watches_[literals[0]].push_back({clause, literals[1], binary});
+    watches_[literals[1]].push_back({clause, literals[0], binary});
+}
+
+void SatSolver::enqueue(int literal, int reason) {
+    int variable = literal >> 1;
+    assigns_[variable] = static_cast<uint8_t>((literal & 1) ^ 1);
+    level_[variable] = decisionLevel();
+    reason_[variable] = reason;
+    trail_.push_back(literal);
+}
+
+// unit propagation over the watch lists; the conflicting clause, or -1
+int SatSolver::propagate() {
+    while (qhead_ < trail_.size()) {
+        int false_literal = trail_[qhead_++] ^ 1;
+        std::vector<Watch>& watching = watches_[false_literal];
+        size_t keep = 0;
+        for (size_t i = 0; i < watching.size(); i++) {
+            Watch watch = watching[i];
+            uint8_t blocker = value(watch.blocker);
+            if (blocker == VALUE_TRUE) {
+                watching[keep++] = watch;
+                continue;
+            }
+            if (watch.binary) {
+                watching[keep++] = watch;
+                if (blocker == VALUE_FALSE) {
+                    for (i++; i < watching.size(); i++) watching[keep++] = watching[i];
+                    watching.resize(keep);
+                    qhead_ = trail_.size();
+                    return watch.clause;
+                }
+                enqueue(watch.blocker, watch.clause);
+                continue;
+            }
+
+            int clause = watch.clause;
+            std::vector<int>& literals = clauses_[clause].literals;
+            if (literals[0] == false_literal) std::swap(literals[0], literals[1]);
+            if (value(literals[0]) == VALUE_TRUE) {
+                watching[keep++] = {clause, literals[0], false};
+                continue;
+            }
+
+            // move the watch to any literal not yet false
+            bool moved = false;
+            for (size_t k = 2; k < literals.size(); k++) {
+                if (value(literals[k]) != VALUE_FALSE) {
+                    std::swap(literals[1], literals[k]);
+                    watches_[literals[1]].push_back({clause, literals[0], false});
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            watching[keep++] = {clause, literals[0], false};
+            if (value(literals[0]) == VALUE_FALSE) {
+                for (i++; i < watching.size(); i++) watching[keep++] = watching[i];
+                watching.resize(keep);
+                qhead_ = trail_.size();
+                return clause;
+            }
+            enqueue(literals[0], clause);
+        }
+        watching.resize(keep);
+    }
+    return -1;
+}
+
+// first-UIP clause of a conflict, asserting its [0] after backtracking to backtrack_level
+void SatSolver::analyze(int conflict, std::vector<int>& learnt, int& backtrack_level, int& lbd) {
+    learnt.assign(1, -1);
+    int pending = 0;
+    int literal = -1;
+    size_t index = trail_.size();
+    do {
+        // every literal of the conflict, or of the reason but the one it implied
+        for (int q : clauses_[conflict].literals) {
+            int variable = q >> 1;
+            if (q == literal) continue;
+            if (seen_[variable] || level_[variable] == 0) continue;
+            bumpVariable(variable);
+            seen_[variable] = 1;
+            if (level_[variable] >= decisionLevel()) pending++;
+            else learnt.push_back(q);
+        }
+        while (!seen_[trail_[--index] >> 1]) {}
+        literal = trail_[index];
+        conflict = reason_[literal >> 1];
+        seen_[literal >> 1] = 0;
+        pending--;
+    } while (pending > 0);
+    learnt[0] = literal ^ 1;
+
+    // drop literals implied by the rest of the clause
+    std::vector<int> marked(learnt.begin() + 1, learnt.end());
+    size_t kept = 1;
+    for (size_t i = 1; i < learnt.size(); i++) {
+        if (!redundant(learnt[i])) learnt[kept++] = learnt[i];
+    }
+    learnt.resize(kept);
+    for (int q : marked) seen_[q >> 1] = 0;
+
+    backtrack_level = 0;
+    if (learnt.size() > 1) {
+        size_t highest = 1;
+        for (size_t i = 2; i < learnt.size(); i++) {
+            if (level_[learnt[i] >> 1] > level_[learnt[highest] >> 1]) highest = i;
+        }
+        std::swap(learnt[1], learnt[highest]);
+        backtrack_level = level_[learnt[1] >> 1];
+    }
+
+    stamp_++;
+    lbd = 0;
+    for (int q : learnt) {
+        int& stamp = level_stamp_[level_[q >> 1]];
+        if (stamp != stamp_) {
+            stamp = stamp_;
+            lbd++;
+        }
+    }
+}
+
+// every other literal of the reason is already in the learnt clause (or fixed at level 0)
+bool SatSolver::redundant(int literal) const {
+    int reason = reason_[literal >> 1];
+    if (reason < 0) return false;
+    for (int q : clauses_[reason].literals) {
+        int variable = q >> 1;
+        if (variable != (literal >> 1) && !seen_[variable] && level_[variable] > 0) return false;
+    }
+    return true;
+}
+
+void SatSolver::cancelUntil(int level) {
+    if (decisionLevel() <= level) return;
+    for (size_t i = trail_.size(); i > static_cast<size_t>(trail_lim_[level]); i--) {
+        int literal = trail_[i - 1];
+        int variable = literal >> 1;
+        assigns_[variable] = VALUE_UNDEF;
+        reason_[variable] = -1;
+        polarity_[variable] = static_cast<uint8_t>(literal & 1);
+        if (heap_index_[variable] < 0) heapInsert(variable);
+    }
+    trail_.resize(trail_lim_[level]);
+    trail_lim_.resize(level);
+    qhead_ = trail_.size();
+}
+
+// at level 0 only, where no learnt clause is a reason: keep the better half by LBD
+void SatSolver::reduceLearnts() {
+    std::vector<int> lbds;
+    for (const Clause& clause : clauses_) {
+        if (clause.learnt) lbds.push_back(clause.lbd);
+    }
+    std::nth_element(lbds.begin(), lbds.begin() + lbds.size() / 2, lbds.end());
+    int cutoff = std::max(2, lbds[lbds.size() / 2]);
+
+    std::vector<Clause> kept;
+    learnts_ = 0;
+    for (Clause& clause : clauses_) {
+        if (clause.learnt && clause.lbd > cutoff) continue;
+        if (clause.learnt) learnts_++;
+        kept.push_back(std::move(clause));
+    }
+    clauses_.swap(kept);
+    for (std::vector<Watch>& watching : watches_) watching.clear();
+    for (size_t c = 0; c < clauses_.size(); c++) attach(static_cast<int>(c));
+    for (int literal : trail_) reason_[literal >> 1] = -1;
+    max_learnts_ += max_learnts_ / 10;
+}
+
+int SatSolver::pickBranch() {
+    while (!heap_.empty()) {
+        int variable = heapPop();
+        if (assigns_[variable] == VALUE_UNDEF) return 2 * variable + polarity_[variable];
+    }
+    return -1;
+}
+
+// CDCL until a model, a top-level conflict, max_conflicts (a restart: Unknown) or the budget
+SatSolver::Result SatSolver::search(int max_conflicts, SearchBudget* budget) {
+    int conflicts = 0;
+    std::vector<int> learnt;
+    for (;;) {
+        int conflict = propagate();
+        if (conflict >= 0) {
+            conflicts_++;
+            conflicts++;
+            if (decisionLevel() == 0) return Result::Unsat;
+
+            int backtrack_level;
+            int lbd;
+            analyze(conflict, learnt, backtrack_level, lbd);
+            cancelUntil(backtrack_level);
+            if (learnt.size() == 1) {
+                enqueue(learnt[0], -1);
+            } else {
+                clauses_.push_back({learnt, true, lbd});
+                learnts_++;
+                int clause = static_cast<int>(clauses_.size()) - 1;
+                attach(clause);
+                enqueue(learnt[0], clause);
+            }
+            var_inc_ /= VAR_DECAY;
+
+            if ((budget && budget->charge()) || conflicts >= max_conflicts) {
+                cancelUntil(0);
+                return Result::Unknown;
+            }
+            continue;
+        }
+
+        if (decisionLevel() == 0 && learnts_ >= max_learnts_) reduceLearnts();
+        int literal = pickBranch();
+        if (literal < 0) return Result::Sat;
+        trail_lim_.push_back(static_cast<int>(trail_.size()));
+        enqueue(literal, -1);
+    }
+}
+
+SatSolver::Result SatSolver::solve(SearchBudget* budget) {
+    if (!ok_) return Result::Unsat;
+    for (;;) {
+        Result result = search(static_cast<int>(luby(restarts_++) * RESTART_BASE), budget);
+        if (result == Result::Sat) {
+            model_ = assigns_;
+            cancelUntil(0);
+            return result;
+        }
+        if (result == Result::Unsat) {
+            ok_ = false;
+            return result;
+        }
+        if (budget && budget->isExhausted()) return Result::Unknown;
+    }
+}
+
+void SatSolver::bumpVariable(int variable) {
+    if ((activity_[variable] += var_inc_) > 1e100) {
+        for (double& activity : activity_) activity *= 1e-100;
+        var_inc_ *= 1e-100;
+    }
+    if (heap_index_[variable] >= 0) heapUp(heap_index_[variable]);
+}
+
+void SatSolver::heapInsert(int variable) {
+    heap_index_[variable] = static_cast<int>(heap_.size());
+    heap_.push_back(variable);
+    heapUp(heap_index_[variable]);
+}
+
+int SatSolver::heapPop() {
+    int top = heap_[0];
+    heap_[0] = heap_.back();
+    heap_index_[heap_[0]] = 0;
+    heap_.pop_back();
+    heap_index_[top] = -1;
+    if (!heap_.empty()) heapDown(0);
+    return top;
+}
+
+void SatSolver::heapUp(int position) {
+    int variable = heap_[position];
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (!before(variable, heap_[parent])) break;
+        heap_[position] = heap_[parent];
+        heap_index_[heap_[position]] = position;
+        position = parent;
+    }
+    heap_[position] = variable;
+    heap_index_[variable] = position;
+}
+
+void SatSolver::heapDown(int position) {
+    int variable = heap_[position];
+    int size = static_cast<int>(heap_.size());
+    for (;;) {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && before(heap_[child + 1], heap_[child])) child++;
+        if (!before(heap_[child], variable)) break;
+        heap_[position] = heap_[child];
+        heap_index_[heap_[position]] = position;
+        position = child;
+    }
+    heap_[position] = variable;
+    heap_index_[variable] = position;
+}
@@ -0,0 +1,71 @@
+#include "../include/ThreadPool.h"
+
+int ThreadPool::resolveThreads(int num_threads) {
+    if (num_threads > 0) return num_threads;
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return (hardware > 0) ? hardware : 1;
+}
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads_(resolveThreads(num_threads)), task_(nullptr), count_(0), next_index_(0), generation_(0),
+      busy_(0), stopping_(false) {
+    // the calling thread is worker 0 of every call
+    for (int worker = 1; worker < num_threads_; worker++) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::runTasks(int worker) {
+    for (int index = next_index_++; index < count_; index = next_index_++) {
+        (*task_)(index, worker);
+    }
+}
+
+void ThreadPool::workerLoop(int worker) {
+    long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+        runTasks(worker);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int index, int worker)>& task) {
+    if (threads_.empty() || count <= 1) {
+        for (int index = 0; index < count; index++) task(index, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_index_ = 0;
+        busy_ = static_cast<int>(threads_.size());
+        generation_++;
+    }
+    wake_.notify_all();
+    runTasks(0);
+
+    // the task must outlive every worker still handing out indices
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_ == 0; });
+    task_ = nullptr;
+}
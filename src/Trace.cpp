@@ -0,0 +1,112 @@
+#include "../include/Trace.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+const char* const CATEGORY_NAMES[] = {"qi", "search", "mc"};
+const char* const LEVEL_NAMES[] = {"off", "info", "debug", "detail"};
+
+// flushed to the sink once this much output is pending
+const size_t SINK_CHUNK = 1 << 16;
+
+std::mutex sink_mutex;
+std::string pending;
+FILE* sink = stderr;
+bool flush_registered = false;
+
+// called with sink_mutex held; pending output is written when the process exits
+void registerFlush() {
+    if (!flush_registered) {
+        std::atexit(Trace::flush);
+        flush_registered = true;
+    }
+}
+
+} // namespace
+
+// the build options keep their old meaning as the starting configuration
+int Trace::levels_[static_cast<int>(TraceCategory::Count)] = {
+    VERBOSE_QI_DEBUG ? static_cast<int>(TraceLevel::Detail) : 0,
+    VERBOSE_QI_DEBUG ? static_cast<int>(TraceLevel::Detail) : 0,
+    VERBOSE_MC_OPERATIONS ? static_cast<int>(TraceLevel::Debug) : 0,
+};
+
+bool Trace::configure(const std::string& spec, std::string& error) {
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) end = spec.size();
+        std::string item = spec.substr(start, end - start);
+        start = end + 1;
+        if (item.empty()) continue;
+
+        size_t colon = item.find(':');
+        std::string name = item.substr(0, colon);
+        std::string level_name = colon == std::string::npos ? "debug" : item.substr(colon + 1);
+
+        int level = -1;
+        for (int l = 0; l <= static_cast<int>(TraceLevel::Detail); l++) {
+            if (level_name == LEVEL_NAMES[l]) level = l;
+        }
+        if (level < 0) {
+            error = "unknown trace level " + level_name + " (expected off, info, debug or detail)";
+            return false;
+        }
+
+        bool matched = false;
+        for (int c = 0; c < static_cast<int>(TraceCategory::Count); c++) {
+            if (name == "all" || name == CATEGORY_NAMES[c]) {
+                levels_[c] = level;
+                matched = true;
+            }
+        }
+        if (!matched) {
+            error = "unknown trace category " + name + " (expected qi, search, mc or all)";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Trace::setSink(const std::string& path, std::string& error) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        error = "Could not open trace file " + path;
+        return false;
+    }
+    flush();
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (sink != stderr) std::fclose(sink);
+    sink = file;
+    return true;
+}
+
+void Trace::write(const char* format, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0) return;
+    if (length >= static_cast<int>(sizeof(line))) length = sizeof(line) - 1; // truncated
+
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    registerFlush();
+    pending.append(line, length);
+    if (pending.size() >= SINK_CHUNK) {
+        std::fwrite(pending.data(), 1, pending.size(), sink);
+        pending.clear();
+    }
+}
+
+void Trace::flush() {
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (!pending.empty()) {
+        std::fwrite(pending.data(), 1, pending.size(), sink);
+        pending.clear();
+    }
+    std::fflush(sink);
+}
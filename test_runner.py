@@ -6,6 +6,7 @@ This module runs the qi_validate C++ program on all graphs in the graphs directo
 and collects results into a summary report.
 """
 
+import json
 import os
 import subprocess
 import tempfile
@@ -13,6 +14,9 @@ from pathlib import Path
 from typing import Dict, List, Tuple
 import glob
 
+# largest graph qi_validate accepts (Partition::MAX_VERTICES)
+MAX_VERTICES = 256
+
 
 class ValidationResult:
     """Represents the result of validating a single graph."""
@@ -30,6 +34,42 @@ class ValidationResult:
     
     def __str__(self):
         return f"{self.graph_name}: {self.result} ({self.vertices}v, k'={self.critical_k}, {self.steps} steps)"
+    
+    def to_json(self) -> str:
+        """One checkpoint line."""
+        return json.dumps({
+            "graph": self.graph_file, "vertices": self.vertices, "critical_k": self.critical_k,
+            "steps": self.steps, "result": self.result, "detail": self.detail,
+            "success": self.success, "error": self.error_message,
+        })
+    
+    @staticmethod
+    def from_json(line: str) -> "ValidationResult":
+        record = json.loads(line)
+        result = ValidationResult(record["graph"])
+        result.vertices = record["vertices"]
+        result.critical_k = record["critical_k"]
+        result.steps = record["steps"]
+        result.result = record["result"]
+        result.detail = record["detail"]
+        result.success = record["success"]
+        result.error_message = record["error"]
+        return result
+
+
+def load_checkpoint(checkpoint_file: str) -> Dict[str, ValidationResult]:
+    """Results already in a checkpoint file, by graph path; a line cut short by a crash is skipped."""
+    done: Dict[str, ValidationResult] = {}
+    if not os.path.exists(checkpoint_file):
+        return done
+    with open(checkpoint_file, 'r') as f:
+        for line in f:
+            try:
+                result = ValidationResult.from_json(line)
+            except (ValueError, KeyError):
+                continue
+            done[result.graph_file] = result
+    return done
 
 
 class TestRunner:
@@ -60,10 +100,10 @@ class TestRunner:
         try:
             # Check graph size before running validation
             vertex_count = self._get_vertex_count(graph_file)
-            if vertex_count > 30:
+            if vertex_count > MAX_VERTICES:
                 result.result = "SKIPPED"
                 result.vertices = vertex_count
-                result.error_message = f"Graph too large ({vertex_count} vertices > 30 limit)"
+                result.error_message = f"Graph too large ({vertex_count} vertices > {MAX_VERTICES} limit)"
                 return result
             # Create temporary file for output
             with tempfile.NamedTemporaryFile(mode='w+', suffix='.txt', delete=False) as temp_file:
@@ -134,19 +174,42 @@ class TestRunner:
         except Exception:
             return 0  # Default to 0 if can't read
     
-    def run_all_tests(self, graphs_dir: str = "graphs") -> List[ValidationResult]:
-        """Run validation on all graphs and return results."""
-        graph_files = self.find_all_graphs(graphs_dir)
+    def run_all_tests(self, graphs_dir: str = "graphs", shard: Tuple[int, int] = (0, 1),
+                      checkpoint_file: str = "", resume: bool = False) -> List[ValidationResult]:
+        """Run validation on all graphs (or the graphs of one shard) and return results.
+        
+        Graph i of the sorted list belongs to shard i mod n. With a checkpoint file every
+        result is appended to it as soon as it is known; with resume, graphs already in it
+        are not run again.
+        """
+        shard_index, num_shards = shard
+        graph_files = self.find_all_graphs(graphs_dir)[shard_index::num_shards]
+        done = load_checkpoint(checkpoint_file) if checkpoint_file and resume else {}
+        checkpoint = None
+        if checkpoint_file:
+            checkpoint = open(checkpoint_file, 'a' if resume else 'w')
+            if done:
+                checkpoint.write("\n")  # keep a line cut short by a crash on its own
         
         print(f"Found {len(graph_files)} graph files to validate...")
+        if num_shards > 1:
+            print(f"Shard {shard_index}/{num_shards}")
+        if done:
+            print(f"Resuming: {len(done)} results already in {checkpoint_file}")
         print(f"Using validator: {self.qi_validate_exe}")
         print()
         
         for i, graph_file in enumerate(graph_files, 1):
+            if graph_file in done:
+                self.results.append(done[graph_file])
+                continue
             print(f"[{i:3d}/{len(graph_files):3d}] Testing {graph_file}...")
             
             result = self.run_validation(graph_file)
             self.results.append(result)
+            if checkpoint:
+                checkpoint.write(result.to_json() + "\n")
+                checkpoint.flush()
             
             # Print immediate result
             if result.result == "PASS":
@@ -162,6 +225,8 @@ class TestRunner:
             else:
                 print(f"         ERROR: {result.error_message}")
         
+        if checkpoint:
+            checkpoint.close()
         return self.results
     
     def generate_summary_report(self, output_file: str = "validation_summary.txt"):
@@ -226,18 +291,45 @@ def main():
                        help="Path to qi_validate executable")
     parser.add_argument("--output", default="validation_summary.txt",
                        help="Output summary file (default: validation_summary.txt)")
+    parser.add_argument("--shard", default="0/1",
+                       help="Run only shard i of n (graph j belongs to shard j mod n; default: 0/1)")
+    parser.add_argument("--checkpoint", default="",
+                       help="Append each result to this file as soon as it is known")
+    parser.add_argument("--resume", action="store_true",
+                       help="Skip graphs already recorded in the --checkpoint file")
+    parser.add_argument("--merge", nargs="+", metavar="CHECKPOINT",
+                       help="Write the summary of these shard checkpoint files without running anything")
     
     args = parser.parse_args()
     
-    # Check if validator exists
-    if not os.path.exists(args.validator):
-        print(f"Error: Validator executable not found: {args.validator}")
-        print("Please build the project first with CMake")
+    try:
+        shard_index, num_shards = (int(part) for part in args.shard.split("/"))
+    except ValueError:
+        shard_index, num_shards = -1, 0
+    if not 0 <= shard_index < num_shards:
+        print(f"Error: --shard takes i/n with 0 <= i < n, got {args.shard}")
+        return 1
+    if args.resume and not args.checkpoint:
+        print("Error: --resume needs --checkpoint")
         return 1
     
-    # Run tests
     runner = TestRunner(args.validator)
-    results = runner.run_all_tests(args.graphs_dir)
+    if args.merge:
+        merged: Dict[str, ValidationResult] = {}
+        for checkpoint_file in args.merge:
+            merged.update(load_checkpoint(checkpoint_file))
+        runner.results = [merged[graph_file] for graph_file in sorted(merged)]
+        results = runner.results
+    else:
+        # Check if validator exists
+        if not os.path.exists(args.validator):
+            print(f"Error: Validator executable not found: {args.validator}")
+            print("Please build the project first with CMake")
+            return 1
+        
+        # Run tests
+        results = runner.run_all_tests(args.graphs_dir, (shard_index, num_shards),
+                                       args.checkpoint, args.resume)
     
     # Generate summary
     runner.generate_summary_report(args.output)
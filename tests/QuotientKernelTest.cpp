@@ -0,0 +1,528 @@
+// solver paths against brute force on small random graphs and partitions: kernel
+// reduction and coloring lift, the thresholded qi search, the SAT decision, the parallel
+// branch and bound, plus the qi cache file, the certificate verifier and the binary
+// graph format
+#include "../include/Certificate.h"
+#include "../include/Graph.h"
+#include "../include/Partition.h"
+#include "../include/QiBranchAndBound.h"
+#include "../include/QiCache.h"
+#include "../include/QuotientKernel.h"
+#include "../include/SatColoring.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition, ...)                                             \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            std::printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #condition); \
+            std::printf(__VA_ARGS__);                                     \
+            std::printf("\n");                                            \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+Graph randomGraph(int n, double density, std::mt19937_64& rng) {
+    std::bernoulli_distribution edge(density);
+    Graph graph;
+    graph.init(n);
+    graph.critical_k = std::max(2, n / 3);
+    for (int u = 0; u < n; u++) {
+        for (int v = u + 1; v < n; v++) {
+            if (edge(rng)) graph.addEdge(u, v);
+        }
+    }
+    graph.buildAdjacencyLists();
+    return graph;
+}
+
+std::vector<int> randomLabels(int n, int blocks, std::mt19937_64& rng) {
+    std::vector<int> labels(n);
+    for (int v = 0; v < n; v++) labels[v] = (v < blocks) ? v : static_cast<int>(rng() % blocks);
+    std::shuffle(labels.begin(), labels.end(), rng);
+    return labels;
+}
+
+// whether the blocks 0..count-1 of adjacency take at most colors colors, by backtracking
+bool colorable(const std::vector<std::vector<bool>>& adjacency, int colors, std::vector<int>& color, int block) {
+    int count = static_cast<int>(adjacency.size());
+    if (block == count) return true;
+    int used = 0;
+    for (int b = 0; b < block; b++) used = std::max(used, color[b] + 1);
+    for (int c = 0; c < std::min(colors, used + 1); c++) {
+        bool proper = true;
+        for (int b = 0; b < block && proper; b++) proper = !(adjacency[block][b] && color[b] == c);
+        if (!proper) continue;
+        color[block] = c;
+        if (colorable(adjacency, colors, color, block + 1)) return true;
+    }
+    return false;
+}
+
+// chromatic number, with an optimal coloring in color
+int chromaticNumber(const std::vector<std::vector<bool>>& adjacency, std::vector<int>& color) {
+    int count = static_cast<int>(adjacency.size());
+    color.assign(count, 0);
+    for (int colors = 0; colors <= count; colors++) {
+        if (colorable(adjacency, colors, color, 0)) return colors;
+    }
+    return count;
+}
+
+// block adjacency of the partition's quotient, by position in getBlockLabels()
+std::vector<std::vector<bool>> quotientAdjacency(const Graph& graph, const Partition& partition) {
+    int k = partition.getNumBlocks();
+    const int* labels = partition.getBlockLabels();
+    std::vector<std::vector<bool>> adjacency(k, std::vector<bool>(k, false));
+    for (int a = 0; a < k; a++) {
+        for (int b = 0; b < k; b++) {
+            if (a != b) adjacency[a][b] = partition.areBlocksConnectedInQuotient(graph, labels[a], labels[b]);
+        }
+    }
+    return adjacency;
+}
+
+// whether label_colors properly colors the quotient with exactly colors colors
+bool properCover(const std::vector<std::vector<bool>>& adjacency, const Partition& partition,
+                 const int* label_colors, int colors) {
+    int k = partition.getNumBlocks();
+    const int* labels = partition.getBlockLabels();
+    std::vector<int> distinct;
+    for (int a = 0; a < k; a++) {
+        int color = label_colors[labels[a]];
+        if (color < 0 || color >= Partition::MAX_VERTICES) return false;
+        distinct.push_back(color);
+        for (int b = 0; b < a; b++) {
+            if (adjacency[a][b] && color == label_colors[labels[b]]) return false;
+        }
+    }
+    std::sort(distinct.begin(), distinct.end());
+    return std::unique(distinct.begin(), distinct.end()) - distinct.begin() == colors;
+}
+
+// optimal kernel colorings lift to proper quotient colorings with one color more per
+// universal block, and the kernel keeps qi
+void testLiftColoring(std::mt19937_64& rng) {
+    for (int trial = 0; trial < 400; trial++) {
+        int n = 4 + static_cast<int>(rng() % 11);
+        Graph graph = randomGraph(n, 0.2 + 0.6 * (trial % 5) / 4.0, rng);
+        std::vector<int> labels = randomLabels(n, 1 + static_cast<int>(rng() % n), rng);
+        Partition partition(labels.data(), n);
+        std::vector<std::vector<bool>> adjacency = quotientAdjacency(graph, partition);
+
+        QuotientKernel kernel(partition.getQuotientGraph(graph));
+        int count = kernel.getBlockCount();
+        BlockSet<4> kernel_rows[BlockSet<4>::CAPACITY];
+        kernel.copyAdjacency(kernel_rows);
+        std::vector<std::vector<bool>> kernel_adjacency(count, std::vector<bool>(count, false));
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) kernel_adjacency[i][j] = kernel_rows[i].test(j);
+        }
+
+        std::vector<int> kernel_color;
+        std::vector<int> quotient_color;
+        int kernel_chi = chromaticNumber(kernel_adjacency, kernel_color);
+        int quotient_chi = chromaticNumber(adjacency, quotient_color);
+        CHECK(quotient_chi == kernel_chi + kernel.getUniversalBlocks(), "trial %d: chi %d, kernel %d + %d",
+              trial, quotient_chi, kernel_chi, kernel.getUniversalBlocks());
+        CHECK(partition.getNumBlocks() - quotient_chi == count - kernel_chi + kernel.getQiOffset(),
+              "trial %d: qi offset %d", trial, kernel.getQiOffset());
+
+        int label_colors[Partition::MAX_VERTICES];
+        kernel.liftColoring(kernel_color.data(), label_colors);
+        CHECK(properCover(adjacency, partition, label_colors, quotient_chi), "trial %d: lifted cover", trial);
+    }
+}
+
+// every threshold, including those the kernel's offset already meets: the answer agrees
+// with brute force and the witness left behind is a proper cover
+void testThresholds(std::mt19937_64& rng) {
+    for (int trial = 0; trial < 300; trial++) {
+        int n = 4 + static_cast<int>(rng() % 11);
+        Graph graph = randomGraph(n, 0.2 + 0.6 * (trial % 5) / 4.0, rng);
+        std::vector<int> labels = randomLabels(n, 1 + static_cast<int>(rng() % n), rng);
+
+        Partition reference(labels.data(), n);
+        std::vector<std::vector<bool>> adjacency = quotientAdjacency(graph, reference);
+        std::vector<int> color;
+        int k = reference.getNumBlocks();
+        int truth = k - chromaticNumber(adjacency, color);
+        int offset = QuotientKernel(reference.getQuotientGraph(graph)).getQiOffset();
+
+        reference.calculateQiNumber(graph);
+        CHECK(reference.getQiNumber() == truth, "trial %d: qi %d, expected %d", trial, reference.getQiNumber(), truth);
+
+        for (int required = 1; required <= k; required++) {
+            Partition partition(labels.data(), n);
+            partition.calculateQiNumber(graph, required);
+            int qi = partition.getQiNumber();
+            if (qi >= required) {
+                CHECK(truth >= required, "trial %d: qi >= %d certified, truth %d", trial, required, truth);
+            } else {
+                CHECK(truth < required, "trial %d: qi >= %d refuted (%d), truth %d", trial, required, qi, truth);
+            }
+
+            int label_colors[Partition::MAX_VERTICES];
+            if (partition.getWitnessCover(label_colors)) {
+                int witness_qi = partition.getWitnessQi();
+                CHECK(witness_qi <= truth, "trial %d: witness qi %d, truth %d", trial, witness_qi, truth);
+                CHECK(properCover(adjacency, partition, label_colors, k - witness_qi),
+                      "trial %d: witness for qi >= %d (offset %d)", trial, required, offset);
+            } else {
+                CHECK(required > offset, "trial %d: no witness for qi >= %d below offset %d", trial, required,
+                      offset);
+            }
+        }
+    }
+}
+
+// adjacency matrix of rows over the first count blocks
+template <int Words>
+std::vector<std::vector<bool>> matrixOf(const BlockSet<Words>* rows, int count) {
+    std::vector<std::vector<bool>> adjacency(count, std::vector<bool>(count, false));
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < count; j++) adjacency[i][j] = rows[i].test(j);
+    }
+    return adjacency;
+}
+
+template <int Words>
+void randomRows(BlockSet<Words>* rows, int count, double density, std::mt19937_64& rng) {
+    std::bernoulli_distribution edge(density);
+    for (int i = 0; i < count; i++) rows[i] = BlockSet<Words>::none();
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (edge(rng)) {
+                rows[i].set(j);
+                rows[j].set(i);
+            }
+        }
+    }
+}
+
+// whether color (one per block) is proper on adjacency with at most colors colors
+bool properColoring(const std::vector<std::vector<bool>>& adjacency, const std::vector<int>& color, int colors) {
+    int count = static_cast<int>(adjacency.size());
+    for (int a = 0; a < count; a++) {
+        if (color[a] < 0 || color[a] >= colors) return false;
+        for (int b = 0; b < a; b++) {
+            if (adjacency[a][b] && color[a] == color[b]) return false;
+        }
+    }
+    return true;
+}
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// the SAT decision agrees with exhaustive coloring at every color count, and its
+// colorings are proper
+void testSatColoring(std::mt19937_64& rng) {
+    for (int trial = 0; trial < 150; trial++) {
+        int count = 2 + static_cast<int>(rng() % 11);
+        SatColoring::Row rows[SatColoring::Row::CAPACITY];
+        randomRows(rows, count, 0.2 + 0.6 * (trial % 5) / 4.0, rng);
+        std::vector<std::vector<bool>> adjacency = matrixOf(rows, count);
+        std::vector<int> optimal;
+        int chi = chromaticNumber(adjacency, optimal);
+
+        for (int colors = 1; colors <= count; colors++) {
+            SatColoring coloring(rows, count);
+            SatSolver::Result result = coloring.decide(colors, nullptr);
+            CHECK(result == (chi <= colors ? SatSolver::Result::Sat : SatSolver::Result::Unsat),
+                  "trial %d: %d colors, chi %d", trial, colors, chi);
+            if (result != SatSolver::Result::Sat) continue;
+            std::vector<int> color(count);
+            for (int b = 0; b < count; b++) color[b] = coloring.getColor(b);
+            CHECK(properColoring(adjacency, color, colors), "trial %d: SAT coloring with %d colors", trial, colors);
+        }
+    }
+}
+
+// a search split across threads proves the serial interval, with a proper coloring;
+// trivial quotients still report one
+void testParallelBranchAndBound(std::mt19937_64& rng) {
+    for (int trial = 0; trial < 6; trial++) {
+        int count = 48 + trial;
+        BlockSet<1> rows[BlockSet<1>::CAPACITY];
+        randomRows(rows, count, 0.5, rng);
+        std::vector<std::vector<bool>> adjacency = matrixOf(rows, count);
+
+        QiBranchAndBound<1> serial(rows, count, nullptr);
+        QiBounds expected = serial.solve();
+        QiBranchAndBound<1> parallel(rows, count, nullptr);
+        parallel.setThreads(4);
+        QiBounds bounds = parallel.solve();
+        CHECK(bounds.lower == expected.lower && bounds.upper == expected.upper,
+              "trial %d: parallel [%d, %d], serial [%d, %d]", trial, bounds.lower, bounds.upper, expected.lower,
+              expected.upper);
+
+        std::vector<int> color(count);
+        for (int b = 0; b < count; b++) color[b] = parallel.getColor(b);
+        CHECK(parallel.hasColoring() && properColoring(adjacency, color, count - bounds.lower),
+              "trial %d: parallel coloring", trial);
+    }
+
+    for (int count = 0; count <= 1; count++) {
+        BlockSet<1> rows[1] = {BlockSet<1>::none()};
+        QiBranchAndBound<1> solver(rows, count, nullptr);
+        QiBounds bounds = solver.solve(1);
+        CHECK(bounds.lower == 0 && bounds.upper == 0 && solver.hasColoring(), "%d blocks", count);
+        CHECK(count == 0 || solver.getColor(0) == 0, "single block color %d", solver.getColor(0));
+    }
+}
+
+// entries survive a save and load keyed by isomorphism class; entries a file cannot
+// back up are dropped
+void testCacheRoundTrip(std::mt19937_64& rng) {
+    QiCache cache;
+    std::vector<std::string> keys;
+    std::vector<QiCache::Entry> entries;
+    std::vector<std::vector<int>> labelings;
+    std::vector<Graph> graphs;
+    for (int trial = 0; trial < 40; trial++) {
+        int n = 14 + static_cast<int>(rng() % 6);
+        graphs.push_back(randomGraph(n, 0.3 + 0.1 * (trial % 4), rng));
+        labelings.push_back(randomLabels(n, QiCache::MIN_BLOCKS + static_cast<int>(rng() % 3), rng));
+        const Graph& graph = graphs.back();
+        Partition partition(labelings.back().data(), n);
+        int k = partition.getNumBlocks();
+
+        int order[QiCache::MAX_BLOCKS];
+        std::string key = QiCache::canonicalKey(partition.getQuotientGraph(graph), order);
+        std::vector<std::vector<bool>> adjacency = quotientAdjacency(graph, partition);
+        std::vector<int> optimal;
+        int chi = chromaticNumber(adjacency, optimal);
+
+        // the optimal coloring by canonical position
+        const int* block_labels = partition.getBlockLabels();
+        QiCache::Entry entry;
+        entry.bounds = {k - chi, k - chi};
+        entry.colors.resize(k);
+        for (int i = 0; i < k; i++) {
+            int position = static_cast<int>(std::find(block_labels, block_labels + k, order[i]) - block_labels);
+            entry.colors[i] = static_cast<uint8_t>(optimal[position]);
+        }
+        cache.store(key, entry);
+        keys.push_back(key);
+        entries.push_back(entry);
+    }
+
+    std::string path = tempPath("qi_kernel_test.qic");
+    std::string error;
+    CHECK(cache.save(path, error), "save: %s", error.c_str());
+    QiCache loaded;
+    size_t dropped = 0;
+    CHECK(loaded.load(path, error, dropped) && dropped == 0, "load: %s, %zu dropped", error.c_str(), dropped);
+    CHECK(loaded.size() == cache.size(), "%zu entries loaded, %zu saved", loaded.size(), cache.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        QiCache::Entry entry;
+        CHECK(loaded.lookup(keys[i], entry), "entry %zu missing", i);
+        CHECK(entry.bounds.lower == entries[i].bounds.lower && entry.bounds.upper == entries[i].bounds.upper,
+              "entry %zu bounds", i);
+    }
+
+    // the same quotient under other labels finds its entry, and the cached colors
+    // placed through the new order are still proper
+    for (size_t i = 0; i < graphs.size(); i++) {
+        std::vector<int> relabeled = labelings[i];
+        std::vector<int> rename(Partition::MAX_VERTICES);
+        for (int label = 0; label < Partition::MAX_VERTICES; label++) rename[label] = label;
+        std::shuffle(rename.begin(), rename.begin() + static_cast<long>(relabeled.size()), rng);
+        for (int& label : relabeled) label = rename[label];
+        Partition partition(relabeled.data(), static_cast<int>(relabeled.size()));
+        int order[QiCache::MAX_BLOCKS];
+        std::string key = QiCache::canonicalKey(partition.getQuotientGraph(graphs[i]), order);
+        QiCache::Entry entry;
+        if (key != keys[i] || !loaded.lookup(key, entry)) continue; // ties may keep block order
+        int label_colors[Partition::MAX_VERTICES];
+        for (int j = 0; j < partition.getNumBlocks(); j++) label_colors[order[j]] = entry.colors[j];
+        CHECK(properCover(quotientAdjacency(graphs[i], partition), partition, label_colors,
+                          partition.getNumBlocks() - entry.bounds.lower),
+              "relabeled entry %zu", i);
+    }
+
+    // an improper coloring, a color past the block count and an interval above k - 1
+    QiCache tampered;
+    for (int variant = 0; variant < 3; variant++) {
+        QiCache::Entry entry = entries[variant];
+        int k = static_cast<int>(entry.colors.size());
+        if (variant == 0) std::fill(entry.colors.begin(), entry.colors.end(), 0);
+        if (variant == 1) entry.colors[0] = static_cast<uint8_t>(k);
+        if (variant == 2) entry.bounds = {k, k};
+        tampered.store(keys[variant], entry);
+    }
+    tampered.store(keys[3], entries[3]);
+    CHECK(tampered.save(path, error), "save: %s", error.c_str());
+    QiCache reloaded;
+    CHECK(reloaded.load(path, error, dropped) && dropped == 3 && reloaded.size() == 1,
+          "tampered file: %zu dropped, %zu kept", dropped, reloaded.size());
+    std::filesystem::remove(path);
+}
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+}
+
+void writeLines(const std::string& path, const std::vector<std::string>& lines) {
+    std::ofstream out(path);
+    for (const std::string& line : lines) out << line << '\n';
+}
+
+// a chain of real Mc merges verifies; dropped steps are reported and a merge of two
+// blocks that are not adjacent is rejected
+void testCertificates(std::mt19937_64& rng) {
+    std::string path = tempPath("qi_kernel_test.cert.jsonl");
+    std::string error;
+    for (int trial = 0; trial < 10; trial++) {
+        int n = 10 + static_cast<int>(rng() % 5);
+        Graph graph = randomGraph(n, 0.4, rng);
+        graph.critical_k = n;   // every partition passes: qi >= k - n + 1 holds trivially
+
+        std::vector<int> labels(n);
+        for (int v = 0; v < n; v++) labels[v] = v;
+        Partition partition(labels.data(), n);
+        CertificateWriter writer;
+        CHECK(writer.open(path, "random", graph, 1), "open %s", path.c_str());
+        int steps = 0;
+        for (int step = 0;; step++) {
+            partition.calculateQiNumber(graph, partition.getNumBlocks() - graph.critical_k + 1);
+            writer.writeStep(step, partition);
+            steps = step;
+
+            // merge the first adjacent pair of blocks, if any
+            const int* block_labels = partition.getBlockLabels();
+            int block1 = -1, block2 = -1;
+            for (int a = 0; a < partition.getNumBlocks() && block1 < 0; a++) {
+                for (int b = a + 1; b < partition.getNumBlocks() && block1 < 0; b++) {
+                    if (partition.areBlocksConnectedInQuotient(graph, block_labels[a], block_labels[b])) {
+                        block1 = block_labels[a];
+                        block2 = block_labels[b];
+                    }
+                }
+            }
+            if (block1 < 0) break;
+            partition.mergeBlocks(block1, block2);
+        }
+        writer = CertificateWriter();
+
+        CertificateVerifier verifier(graph);
+        CHECK(verifier.verify(path, error) && verifier.getStepsVerified() == steps + 1 &&
+                  verifier.getMissingSteps().empty(),
+              "trial %d: chain of %d steps: %s", trial, steps, error.c_str());
+
+        // header, then steps 0..steps: drop step 1
+        std::vector<std::string> lines = readLines(path);
+        if (lines.size() < 4) continue;
+        lines.erase(lines.begin() + 2);
+        writeLines(path, lines);
+        CHECK(verifier.verify(path, error) && verifier.getMissingSteps() == std::vector<int>{1},
+              "trial %d: missing step not reported: %s", trial, error.c_str());
+    }
+
+    // path 0-1-2-3: merging blocks 0 and 2 is not an Mc operation
+    Graph path_graph;
+    path_graph.init(4);
+    path_graph.critical_k = 4;
+    for (int v = 0; v < 3; v++) path_graph.addEdge(v, v + 1);
+    path_graph.buildAdjacencyLists();
+    writeLines(path, {"{\"graph\":\"path\",\"vertices\":4,\"critical_k\":4,\"seed\":1}",
+                      "{\"step\":0,\"blocks\":4,\"colors\":2,\"labels\":[0,1,2,3],\"cover\":[0,1,0,1]}",
+                      "{\"step\":1,\"blocks\":3,\"colors\":2,\"labels\":[0,1,0,3],\"cover\":[0,1,0,1]}"});
+    CertificateVerifier verifier(path_graph);
+    CHECK(!verifier.verify(path, error), "non-adjacent merge accepted");
+
+    // and a record the merges could not have produced from the singletons at all
+    writeLines(path, {"{\"graph\":\"path\",\"vertices\":4,\"critical_k\":4,\"seed\":1}",
+                      "{\"step\":2,\"blocks\":2,\"colors\":2,\"labels\":[0,1,1,0],\"cover\":[0,1,1,0]}"});
+    CHECK(!verifier.verify(path, error), "disconnected blocks at the first record accepted");
+    std::filesystem::remove(path);
+}
+
+// saveBinary and loading back give the graph the text file describes; damaged rows are
+// rejected
+void testBinaryGraphs(std::mt19937_64& rng) {
+    std::string text_path = tempPath("qi_kernel_test.txt");
+    std::string binary_path = tempPath("qi_kernel_test.qig");
+    std::string error;
+    std::string warning;
+    for (int trial = 0; trial < 20; trial++) {
+        int n = 1 + static_cast<int>(rng() % Partition::MAX_VERTICES);
+        Graph source = randomGraph(n, 0.05 + 0.1 * (trial % 5), rng);
+        {
+            std::ofstream out(text_path);
+            out << n << '\n';
+            for (int u = 0; u < n; u++) {
+                for (int v = u + 1; v < n; v++) {
+                    if (source.hasEdge(u, v)) out << u << ' ' << v << '\n';
+                }
+            }
+            out << "k=" << source.critical_k << '\n';
+        }
+        Graph text;
+        CHECK(text.loadFromFile(text_path.c_str(), error, warning), "trial %d: text: %s", trial, error.c_str());
+        CHECK(text.saveBinary(binary_path.c_str()), "trial %d: save", trial);
+        Graph binary;
+        CHECK(binary.loadFromFile(binary_path.c_str(), error, warning), "trial %d: binary: %s", trial, error.c_str());
+
+        bool same = binary.num_vertices == n && binary.critical_k == text.critical_k &&
+                    binary.getEdgeCount() == text.getEdgeCount();
+        for (int u = 0; u < n && same; u++) {
+            same = binary.getDegree(u) == text.getDegree(u) &&
+                   std::equal(binary.getNeighbours(u), binary.getNeighbours(u) + binary.getDegree(u),
+                              text.getNeighbours(u));
+        }
+        CHECK(same, "trial %d: binary and text graphs differ (n=%d)", trial, n);
+    }
+
+    // a loop on vertex 0: the first row word of the file sits right after the header
+    {
+        std::fstream file(binary_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(16);
+        char first = 0;
+        file.read(&first, 1);
+        file.seekp(16);
+        first |= 1;
+        file.write(&first, 1);
+    }
+    Graph damaged;
+    CHECK(!damaged.loadFromFile(binary_path.c_str(), error, warning), "loop in a binary row accepted");
+    std::filesystem::remove(text_path);
+    std::filesystem::remove(binary_path);
+}
+
+} // namespace
+
+int main() {
+    // every threshold should reach the solvers rather than an earlier trial's entry
+    QiCache::global().setEnabled(false);
+
+    std::mt19937_64 rng(20240611);
+    testLiftColoring(rng);
+    testThresholds(rng);
+    testSatColoring(rng);
+    testParallelBranchAndBound(rng);
+    testCacheRoundTrip(rng);
+    testCertificates(rng);
+    testBinaryGraphs(rng);
+
+    if (failures) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}